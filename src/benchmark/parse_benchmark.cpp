@@ -0,0 +1,195 @@
+/**
+ * \file
+ * \brief Микробенчмарк преобразования текстовых данных трасс ВАЦ в числа
+ *
+ * Для каждого размера трассы формируется ответ ВАЦ в формате ASCII
+ * ("+1.00000000000E-001,-2.00000000000E-001,...") и измеряется время
+ * преобразования ответов всех портов в массивы квадратур двумя способами:
+ * делением строки с помощью string_utils::split() с последующим вызовом
+ * std::strtod() для каждого значения и функцией number_utils::parse_pairs().
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../utils/number_utils.hpp"
+#include "../utils/string_utils.hpp"
+
+/// Стандартное количество портов ВАЦ
+#define DEFAULT_PORT_COUNT          8
+/// Стандартная длительность измерения одного размера трассы в секундах
+#define DEFAULT_MEASURE_TIME        1.0
+
+/// Параметр изменения количества точек трассы
+#define POINTS_PARAM                "-points"
+/// Параметр изменения количества портов ВАЦ
+#define PORTS_PARAM                 "-ports"
+/// Параметр изменения длительности измерения одного размера трассы
+#define TIME_PARAM                  "-time"
+
+/// Разделитель значений в ответе ВАЦ
+#define DATA_DELIMITER              ','
+
+void usage();
+
+/**
+ * \brief Формирование ответа ВАЦ со случайными значениями квадратур
+ *
+ * \param [in] points Количество точек трассы
+ * \param [in] generator Генератор случайных чисел
+ *
+ * \return Строка в формате ответа ВАЦ
+ */
+std::string make_trace(int points, std::mt19937 &generator) {
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    std::string trace{};
+    char value[32];
+
+    for (int pos = 0; pos < 2 * points; ++pos) {
+        std::snprintf(value, sizeof(value), "%+.11E", distribution(generator));
+
+        if (pos != 0) {
+            trace += DATA_DELIMITER;
+        }
+
+        trace += value;
+    }
+
+    return trace;
+}
+
+/**
+ * \brief Преобразование ответа ВАЦ способом, который использовался до
+ * появления number_utils::parse_pairs()
+ *
+ * \param [in] trace Ответ ВАЦ
+ * \param [out] i Массив синфазных составляющих
+ * \param [out] q Массив квадратурных составляющих
+ *
+ * \return Количество прочитанных пар
+ */
+size_t parse_split(const std::string &trace, std::vector<double> &i, std::vector<double> &q) {
+    std::vector<std::string> values = string_utils::split(trace, DATA_DELIMITER);
+
+    i.clear();
+    q.clear();
+
+    for (size_t pos = 0; pos + 1 < values.size(); pos += 2) {
+        i.push_back(std::strtod(values[pos].c_str(), nullptr));
+        q.push_back(std::strtod(values[pos + 1].c_str(), nullptr));
+    }
+
+    return i.size();
+}
+
+/**
+ * \brief Измерение среднего времени преобразования ответов всех портов
+ *
+ * Преобразование повторяется, пока не пройдёт заданное время.
+ *
+ * \param [in] parse Функция преобразования одного ответа
+ * \param [in] port_count Количество портов ВАЦ
+ * \param [in] measure_time Длительность измерения в секундах
+ *
+ * \return Среднее время преобразования ответов всех портов в микросекундах
+ */
+template<typename Parse>
+double measure(Parse &&parse, int port_count, double measure_time) {
+    using clock = std::chrono::steady_clock;
+
+    size_t repeats = 0;
+    size_t checksum = 0;
+
+    clock::time_point start = clock::now();
+    std::chrono::duration<double> elapsed{};
+
+    do {
+        for (int port = 0; port < port_count; ++port) {
+            checksum += parse();
+        }
+
+        ++repeats;
+        elapsed = clock::now() - start;
+    } while (elapsed.count() < measure_time);
+
+    if (checksum == 0) {
+        std::cout << "Trace data wasn't parsed" << std::endl;
+    }
+
+    return elapsed.count() * 1e6 / (double) repeats;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<int> points_list = {201, 1601, 20001};
+    int port_count = DEFAULT_PORT_COUNT;
+    double measure_time = DEFAULT_MEASURE_TIME;
+
+    for (int arg_pos = 1; arg_pos < argc; ++arg_pos) {
+        if (arg_pos + 1 == argc) {
+            usage();
+            return 0;
+        }
+
+        const char *value = argv[arg_pos + 1];
+
+        if (strcmp(argv[arg_pos], POINTS_PARAM) == 0) {
+            points_list = {atoi(value)};
+        } else if (strcmp(argv[arg_pos], PORTS_PARAM) == 0) {
+            port_count = atoi(value);
+        } else if (strcmp(argv[arg_pos], TIME_PARAM) == 0) {
+            measure_time = atof(value);
+        } else {
+            usage();
+            return 0;
+        }
+
+        ++arg_pos;
+    }
+
+    std::mt19937 generator(1);
+
+    std::vector<double> i{};
+    std::vector<double> q{};
+
+    std::printf("%8s %6s %16s %16s %8s\n", "points", "ports", "split, us", "from_chars, us", "speedup");
+
+    for (int points : points_list) {
+        std::string trace = make_trace(points, generator);
+        const char *begin = trace.data();
+        const char *end = trace.data() + trace.size();
+
+        double split_time = measure([&]() {
+            return parse_split(trace, i, q);
+        }, port_count, measure_time);
+
+        double parse_time = measure([&]() {
+            return number_utils::parse_pairs(begin, end, DATA_DELIMITER, i, q);
+        }, port_count, measure_time);
+
+        std::printf("%8d %6d %16.1f %16.1f %7.1fx\n", points, port_count, split_time, parse_time, split_time / parse_time);
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Вывод справки по параметрам запуска
+ */
+void usage() {
+    std::cout << "\n===== AntestL Parse Benchmark =====\n" << std::endl;
+
+    std::cout << "Usage:" << std::endl;
+    std::cout << "-points -- sets trace points count (default: 201, 1601 and 20001)" << std::endl;
+    std::cout << "-ports  -- sets VNA ports count (default: 8)" << std::endl;
+    std::cout << "-time   -- sets measure time for each trace size in seconds (default: 1)" << std::endl;
+}
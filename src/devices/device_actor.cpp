@@ -0,0 +1,68 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса DeviceActor
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "device_actor.hpp"
+
+/**
+ * \brief Конструктор, который запускает поток
+ */
+DeviceActor::DeviceActor() {
+    worker = std::thread(&DeviceActor::run, this);
+}
+
+/**
+ * \brief Деструктор, который выполняет оставшиеся задания и завершает поток
+ */
+DeviceActor::~DeviceActor() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+
+    queue_cv.notify_one();
+    worker.join();
+}
+
+/**
+ * \brief Добавление задания в очередь
+ *
+ * \param [in] job Задание
+ */
+void DeviceActor::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push_back(std::move(job));
+    }
+
+    queue_cv.notify_one();
+}
+
+/**
+ * \brief Функция потока, которая выполняет задания из очереди
+ *
+ * Поток завершается, когда выставлен флаг stopping и очередь пуста.
+ */
+void DeviceActor::run() {
+    while (true) {
+        std::function<void()> job{};
+
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            if (queue.empty()) {
+                return;
+            }
+
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        job();
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс DeviceActor
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_DEVICE_ACTOR_HPP
+#define ANTESTL_BACKEND_DEVICE_ACTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+/**
+ * \brief Класс потока ввода-вывода прибора
+ *
+ * Поток выполняет задания из очереди по одному в порядке их добавления, поэтому
+ * команды, переданные одному прибору, не перемешиваются, а команды разных
+ * приборов выполняются параллельно. Результат задания (или исключение, которое
+ * оно бросило) возвращается через std::future.
+ *
+ * **Пример**
+ * \code
+ * DeviceActor actor{};
+ *
+ * std::future<std::string> answer = actor.submit([&vna]() {
+ *     return vna.send("*IDN?");
+ * });
+ *
+ * // Здесь можно работать с другими приборами
+ *
+ * std::cout << answer.get() << std::endl;
+ * \endcode
+ */
+class DeviceActor {
+    /// Очередь заданий
+    std::deque<std::function<void()>> queue{};
+
+    /// Мьютекс, который защищает очередь заданий
+    std::mutex queue_mutex{};
+    /// Условная переменная, по которой поток ожидает новые задания
+    std::condition_variable queue_cv{};
+
+    /// Флаг, показывающий, что поток должен завершиться
+    bool stopping = false;
+
+    /// Поток, который выполняет задания
+    std::thread worker{};
+
+    void run();
+    void post(std::function<void()> job);
+
+public:
+    DeviceActor();
+    ~DeviceActor();
+
+    DeviceActor(const DeviceActor &) = delete;
+    DeviceActor &operator=(const DeviceActor &) = delete;
+
+    /**
+     * \brief Добавление задания в очередь потока
+     *
+     * \param [in] function Функция, которая будет выполнена в потоке прибора
+     *
+     * \return Объект std::future, через который возвращается результат функции.
+     * Метод get() бросает исключение, если его бросила функция.
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F &&function) {
+        using result_t = std::invoke_result_t<F>;
+
+        auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(function));
+        std::future<result_t> result = task->get_future();
+
+        post([task]() { (*task)(); });
+
+        return result;
+    }
+};
+
+#endif //ANTESTL_BACKEND_DEVICE_ACTOR_HPP
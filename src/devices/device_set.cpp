@@ -44,6 +44,7 @@ bool DeviceSet::connect(int device_type, std::string device_model, const std::st
                     return false;
                 }
 
+                vna->set_abort_signal(abort_signal);
                 vna->preset();
                 return vna->is_connected();
             case DEVICE_GEN:
@@ -73,6 +74,73 @@ bool DeviceSet::connect(int device_type, std::string device_model, const std::st
     }
 }
 
+/**
+ * \brief Метод, позволяющий подключиться к нескольким устройствам одновременно
+ *
+ * Устройства разных типов (ВАЦ, генератор, ОПУ) подключаются в отдельных потоках,
+ * поэтому время подключения определяется самым медленным устройством, а не суммой
+ * времён. Устройства одного типа подключаются по очереди в порядке следования в
+ * списке.
+ *
+ * \param [in] request_list Список параметров подключения
+ *
+ * \return Вектор, в котором для каждого элемента request_list указано, было ли
+ * подключено устройство
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * std::vector<bool> connected = device_set.connect({
+ *         {DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET"},
+ *         {DEVICE_GEN, "ext_gen", "TCPIP0::localhost::5026::SOCKET"},
+ *         {DEVICE_RBD, "tesart_rbd", "TCPIP0::localhost::5027::SOCKET;TCPIP0::localhost::5028::SOCKET"}
+ * });
+ * \endcode
+ */
+std::vector<bool> DeviceSet::connect(const std::vector<connect_request_t> &request_list) {
+    std::vector<char> connected(request_list.size(), false);
+    std::vector<std::future<void>> connect_list{};
+
+    for (int device_type : {DEVICE_VNA, DEVICE_GEN, DEVICE_RBD}) {
+        bool requested = std::any_of(
+                request_list.begin(), request_list.end(),
+                [device_type](const connect_request_t &request) { return request.device_type == device_type; });
+
+        if (!requested) {
+            continue;
+        }
+
+        connect_list.push_back(std::async(std::launch::async, [this, device_type, &request_list, &connected]() {
+            for (size_t pos = 0; pos < request_list.size(); ++pos) {
+                const connect_request_t &request = request_list[pos];
+
+                if (request.device_type == device_type) {
+                    connected[pos] = connect(request.device_type, request.device_model, request.device_address);
+                }
+            }
+        }));
+    }
+
+    std::exception_ptr connect_error{};
+
+    for (std::future<void> &connect_result : connect_list) {
+        try {
+            connect_result.get();
+        } catch (...) {
+            if (connect_error == nullptr) {
+                connect_error = std::current_exception();
+            }
+        }
+    }
+
+    if (connect_error != nullptr) {
+        std::rethrow_exception(connect_error);
+    }
+
+    return {connected.begin(), connected.end()};
+}
+
 /**
  * \brief Отключает все устройства и уничтожает созданные объекты
  */
@@ -80,6 +148,10 @@ void DeviceSet::disconnect() {
     delete vna;
     delete ext_gen;
     delete rbd;
+
+    vna = nullptr;
+    ext_gen = nullptr;
+    rbd = nullptr;
 }
 
 /**
@@ -89,6 +161,7 @@ void DeviceSet::disconnect() {
  * \param [in] rbw Полоса разрешающего фильтра
  * \param [in] source_port Зондирующий порт
  * \param [in] using_ext_gen Флаг, показывающий, используется ли внешний генератор
+ * \param [in] gen_sweep_mode Режим перестройки частоты внешнего генератора
  *
  * \return Если ВАЦ был сконфигурирован, то возвращает true. В противном случае - false.
  *
@@ -100,7 +173,7 @@ void DeviceSet::disconnect() {
  * device_set.configure(MEAS_TRANSITION, 1e3, 1, false);
  * \endcode
  */
-bool DeviceSet::configure(int meas_type, float rbw, int source_port, bool using_ext_gen) {
+bool DeviceSet::configure(int meas_type, float rbw, int source_port, bool using_ext_gen, int gen_sweep_mode) {
     try {
         vna->full_preset();
         logger::log(LEVEL_TRACE, "Made full preset");
@@ -109,6 +182,7 @@ bool DeviceSet::configure(int meas_type, float rbw, int source_port, bool using_
         logger::log(LEVEL_TRACE, "Default channel initialized");
 
         vna->configure(meas_type, rbw, source_port);
+        vna->error_checkpoint();
 
         this->meas_type = meas_type;
         this->using_ext_gen = using_ext_gen;
@@ -117,12 +191,230 @@ bool DeviceSet::configure(int meas_type, float rbw, int source_port, bool using_
         return false;
     }
 
-    traces_configured = false;
+    if (using_ext_gen && !set_gen_sweep_mode(gen_sweep_mode)) {
+        return false;
+    }
 
     logger::log(LEVEL_DEBUG, "VNA configured");
     return true;
 }
 
+/**
+ * \brief Устанавливает формат, в котором ВАЦ передаёт данные трасс
+ *
+ * \param [in] data_format Формат данных (DATA_FORMAT_ASCII, DATA_FORMAT_REAL32
+ * или DATA_FORMAT_REAL64)
+ * \param [in] swapped_bytes Флаг, показывающий, требуется ли передавать двоичные
+ * данные младшим байтом вперёд
+ *
+ * \return Если формат был установлен, то возвращает true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET");
+ *
+ * device_set.configure(MEAS_TRANSITION, 1e3, 1, false);
+ * device_set.set_data_format(DATA_FORMAT_REAL64, true);
+ * \endcode
+ */
+bool DeviceSet::set_data_format(int data_format, bool swapped_bytes) {
+    try {
+        vna->set_data_format(data_format, swapped_bytes);
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't change data format on VNA");
+        return false;
+    }
+
+    logger::log(LEVEL_DEBUG, "VNA data format = {}; swapped bytes = {}", data_format, swapped_bytes);
+    return true;
+}
+
+/**
+ * \brief Устанавливает способ ожидания завершения действий для ВАЦ и внешнего
+ * генератора
+ *
+ * \param [in] completion Способ ожидания (COMPLETION_OPC_QUERY, COMPLETION_ESR_POLL
+ * или COMPLETION_SRQ)
+ *
+ * \return Если способ ожидания был установлен, то возвращает true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::INSTR");
+ * device_set.set_completion_mode(COMPLETION_SRQ);
+ * \endcode
+ */
+bool DeviceSet::set_completion_mode(int completion) {
+    try {
+        if (!vna->set_completion_mode(completion)) {
+            return false;
+        }
+
+        if (ext_gen != nullptr && !ext_gen->set_completion_mode(completion)) {
+            return false;
+        }
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't change completion mode");
+        return false;
+    }
+
+    logger::log(LEVEL_DEBUG, "Completion mode = {}", completion);
+    return true;
+}
+
+/**
+ * \brief Включает или отключает отложенную проверку ошибок на ВАЦ
+ *
+ * При отложенной проверке очередь ошибок ВАЦ читается только в контрольных точках:
+ * в конце настройки и перед запуском каждого измерения.
+ *
+ * \param [in] deferred_errors Флаг отложенной проверки ошибок
+ *
+ * \return Если режим был установлен, то возвращает true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET");
+ * device_set.set_deferred_errors(true);
+ * device_set.configure(MEAS_TRANSITION, 1e3, 1, false);
+ * \endcode
+ */
+bool DeviceSet::set_deferred_errors(bool deferred_errors) {
+    try {
+        vna->set_deferred_errors(deferred_errors);
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't change error checking mode");
+        return false;
+    }
+
+    logger::log(LEVEL_DEBUG, "Deferred errors = {}", deferred_errors);
+    return true;
+}
+
+/**
+ * \brief Изменяет таймаут выбранного класса для всех подключённых приборов
+ *
+ * Таймауты классов TIMEOUT_SWEEP и TIMEOUT_MOTION задают запас, который
+ * добавляется к ожидаемой длительности измерения или перемещения.
+ *
+ * \param [in] timeout_class Класс таймаута (TIMEOUT_QUERY, TIMEOUT_CONFIG,
+ * TIMEOUT_SWEEP или TIMEOUT_MOTION)
+ * \param [in] timeout Таймаут в миллисекундах
+ *
+ * \return Если таймаут был изменён, то возвращает true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET");
+ * device_set.set_timeout(TIMEOUT_CONFIG, 60000);
+ * \endcode
+ */
+bool DeviceSet::set_timeout(int timeout_class, int timeout) {
+    bool result = vna == nullptr || vna->set_timeout(timeout_class, timeout);
+    result = result && (ext_gen == nullptr || ext_gen->set_timeout(timeout_class, timeout));
+    result = result && (rbd == nullptr || rbd->set_timeout(timeout_class, timeout));
+
+    if (!result) {
+        logger::log(LEVEL_ERROR, "Can't change timeout");
+    }
+
+    return result;
+}
+
+/**
+ * \brief Устанавливает режим перестройки частоты внешнего генератора
+ *
+ * В режиме GEN_SWEEP_LIST_VNA генератор переходит к следующей частотной точке
+ * по триггеру, который ВАЦ формирует после каждого измерения. Так как при
+ * измерении коэффициента отражения ВАЦ проводит несколько измерений в одной
+ * точке, то для него вместо GEN_SWEEP_LIST_VNA используется GEN_SWEEP_LIST_BUS.
+ * По той же причине в режиме GEN_SWEEP_LIST_VNA не выполняется усреднение
+ * (см. get_averaged_data()). GEN_SWEEP_LIST_BUS используется и в том случае,
+ * если ВАЦ не может формировать выходной триггер (см. VnaDevice::has_trigger_output()).
+ *
+ * \param [in] gen_sweep_mode Режим перестройки частоты (GEN_SWEEP_STEP,
+ * GEN_SWEEP_LIST_BUS или GEN_SWEEP_LIST_VNA)
+ *
+ * \return Если режим был установлен, то возвращает true. Если режим неизвестен
+ * или не удалось его установить, то возвращает false.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET");
+ * device_set.connect(DEVICE_GEN, "keysight_gen", "TCPIP0::localhost::5026::SOCKET");
+ *
+ * device_set.configure(MEAS_TRANSITION, 1e3, 1, true);
+ * device_set.set_gen_sweep_mode(GEN_SWEEP_LIST_VNA);
+ * \endcode
+ */
+bool DeviceSet::set_gen_sweep_mode(int gen_sweep_mode) {
+    if (ext_gen == nullptr) {
+        logger::log(LEVEL_ERROR, "External gen is not connected");
+        return false;
+    }
+
+    if (gen_sweep_mode < GEN_SWEEP_STEP || gen_sweep_mode > GEN_SWEEP_LIST_VNA) {
+        logger::log(LEVEL_ERROR, "Unknown external gen sweep mode = {}", gen_sweep_mode);
+        return false;
+    }
+
+    if (gen_sweep_mode == GEN_SWEEP_LIST_VNA && meas_type == MEAS_REFLECTION) {
+        logger::log(LEVEL_WARN, "VNA triggered frequency list can't be used for reflection measurements. Using bus trigger");
+        gen_sweep_mode = GEN_SWEEP_LIST_BUS;
+    }
+
+    if (gen_sweep_mode == GEN_SWEEP_LIST_VNA && !vna->has_trigger_output()) {
+        logger::log(LEVEL_WARN, "VNA has no trigger output. Using bus trigger");
+        gen_sweep_mode = GEN_SWEEP_LIST_BUS;
+    }
+
+    try {
+        // Выходной триггер ВАЦ настраивается, пока в генератор загружается список частот
+        std::future<void> trigger_output = vna->submit([this, gen_sweep_mode]() {
+            vna->set_trigger_output(gen_sweep_mode == GEN_SWEEP_LIST_VNA);
+        });
+
+        try {
+            ext_gen->set_sweep_mode(gen_sweep_mode);
+        } catch (const antestl_exception &exception) {
+            trigger_output.wait();
+            throw;
+        }
+
+        trigger_output.get();
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't change sweep mode on external generator");
+        return false;
+    }
+
+    logger::log(LEVEL_DEBUG, "External gen sweep mode = {}", gen_sweep_mode);
+    return true;
+}
+
+/**
+ * \brief Метод позволяет получить режим перестройки частоты внешнего генератора
+ *
+ * \return Режим перестройки частоты. Если внешний генератор не используется,
+ * то возвращает GEN_SWEEP_STEP.
+ */
+int DeviceSet::get_gen_sweep_mode() const {
+    if (!using_ext_gen || ext_gen == nullptr) {
+        return GEN_SWEEP_STEP;
+    }
+
+    return ext_gen->get_sweep_mode();
+}
+
 /**
  * \brief Устанавливает требуемую мощность зондирующего порта
  *
@@ -363,6 +655,9 @@ double DeviceSet::get_current_freq() {
 /**
  * \brief Получает вектор частотных точек
  *
+ * Вектор вычисляется заново только при изменении начальной частоты, шага или
+ * количества точек ВАЦ, а в остальных случаях возвращается сохранённый вектор.
+ *
  * \return Вектор частотных точек
  *
  * **Пример**
@@ -379,11 +674,20 @@ double DeviceSet::get_current_freq() {
  * }
  * \endcode
  */
-std::vector<double> DeviceSet::get_freq_list() {
-    std::vector<double> freq_list{};
+const std::vector<double> &DeviceSet::get_freq_list() {
+    double start_freq = vna->get_start_freq();
+    double freq_step = vna->get_freq_step();
+    int points = vna->get_points();
+
+    if (start_freq != freq_list_start || freq_step != freq_list_step || points != (int) freq_list.size()) {
+        freq_list.resize(std::max(points, 0));
 
-    for (int pos = 0; pos < vna->get_points(); ++pos) {
-        freq_list.push_back(vna->get_start_freq() + pos * vna->get_freq_step());
+        for (int pos = 0; pos < points; ++pos) {
+            freq_list[pos] = start_freq + pos * freq_step;
+        }
+
+        freq_list_start = start_freq;
+        freq_list_step = freq_step;
     }
 
     return freq_list;
@@ -547,7 +851,8 @@ bool DeviceSet::move_to_start_angle(int axis_num) {
 /**
  * \brief Получает список углов, на которые развёрнуты оси ОПУ
  *
- * \return Строка, содержащая значения углов
+ * \return Вектор, содержащий значения углов всех осей. Если ОПУ не подключено,
+ * то возвращается пустой вектор.
  *
  * **Пример**
  * \code
@@ -557,24 +862,31 @@ bool DeviceSet::move_to_start_angle(int axis_num) {
  * device_set.set_angle_range(-30.0f, 30.0f, 11, 0);
  *
  * while (device_set.next_angle(0) != ANGLE_MOVE_BOUND) {
- *     std::cout << "angle = " << device_set.get_current_angles() << std::endl;
+ *     std::cout << "angle = " << device_set.get_current_angles()[0] << std::endl;
  * }
  * \endcode
  */
-std::string DeviceSet::get_current_angles() {
-    std::string angle_list{};
+std::vector<float> DeviceSet::get_current_angles() {
+    std::vector<float> angle_list{};
+    get_current_angles(angle_list);
+
+    return angle_list;
+}
+
+/**
+ * \brief Записывает углы, на которые развёрнуты оси ОПУ, в существующий вектор
+ *
+ * \param [out] angle_list Вектор, в который записываются значения углов всех осей.
+ * Если ОПУ не подключено, то вектор очищается.
+ */
+void DeviceSet::get_current_angles(std::vector<float> &angle_list) {
+    angle_list.clear();
 
     if (rbd != nullptr && rbd->is_connected()) {
         for (int axis = 0; axis < rbd->get_axes_count(); ++axis) {
-            if (axis == 0) {
-                angle_list = std::to_string(rbd->get_pos(axis));
-            } else {
-                angle_list += "," + std::to_string(rbd->get_pos(axis));
-            }
+            angle_list.push_back(rbd->get_pos(axis));
         }
     }
-
-    return angle_list;
 }
 
 /**
@@ -630,6 +942,42 @@ int DeviceSet::get_vna_switch_module_count()  {
     }
 }
 
+/**
+ * \brief Метод позволяет получить число портов ВАЦ
+ *
+ * \return Количество портов. Если ВАЦ не подключен, то возвращает 0.
+ */
+int DeviceSet::get_vna_port_count() {
+    if (vna != nullptr && vna->is_connected()) {
+        return vna->get_port_count();
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * \brief Метод позволяет получить номер зондирующего порта ВАЦ
+ *
+ * \return Номер зондирующего порта. Если ВАЦ не подключен, то возвращает
+ * DEFAULT_VNA_SOURCE_PORT.
+ */
+int DeviceSet::get_vna_source_port() {
+    if (vna != nullptr) {
+        return vna->get_source_port();
+    } else {
+        return DEFAULT_VNA_SOURCE_PORT;
+    }
+}
+
+/**
+ * \brief Метод позволяет получить тип измерения
+ *
+ * \return Тип измерения (MEAS_TRANSITION или MEAS_REFLECTION)
+ */
+int DeviceSet::get_meas_type() const {
+    return meas_type;
+}
+
 /**
  * \brief Метод позволяет проверить, используется ли внешний генератор
  *
@@ -650,6 +998,38 @@ bool DeviceSet::is_using_ext_gen() const {
     return using_ext_gen;
 }
 
+/**
+ * \brief Оценка времени поворота оси ОПУ на заданный угол
+ *
+ * \param [in] angle_delta Угол, на который поворачивается ось
+ * \param [in] axis_num Номер оси
+ *
+ * \return Ориентировочное время поворота в секундах. Если ОПУ не подключено,
+ * то возвращает 0.
+ */
+double DeviceSet::get_angle_move_time(float angle_delta, int axis_num) {
+    if (rbd == nullptr) {
+        return 0.0;
+    }
+
+    return rbd->get_move_time(angle_delta, axis_num);
+}
+
+/**
+ * \brief Оценка времени перехода к следующей частотной точке
+ *
+ * \return Ориентировочное время перестройки частоты внешнего генератора в
+ * секундах. Если внешний генератор не используется, то частотный диапазон
+ * проходится ВАЦ за одно измерение и возвращается 0.
+ */
+double DeviceSet::get_freq_step_time() {
+    if (!using_ext_gen || ext_gen == nullptr) {
+        return 0.0;
+    }
+
+    return ext_gen->get_retune_time();
+}
+
 /**
  * \brief Метод, осуществляющий проведение измерения и получение результатов
  * измерения
@@ -657,9 +1037,21 @@ bool DeviceSet::is_using_ext_gen() const {
  * \warning Перед использованием данного метода требуется осуществить подключение
  * к нужным устройствам и произвести их настройку!
  *
+ * Результаты записываются в существующую структуру, которая предварительно
+ * очищается вызовом data_t::reset(). Если структура используется для измерения
+ * нескольких точек подряд, то память под массивы выделяется только при первом
+ * измерении.
+ *
+ * При измерении коэффициента отражения все порты из списка включаются одной
+ * посылкой (см. VnaDevice::rf_on(const std::vector<int> &)), и ВАЦ измеряет
+ * трассы всех портов за один запуск измерения, после чего данные читаются одним
+ * составным запросом.
+ *
  * \param [in] port_list Список портов, для которых требуется провести измерение
+ * \param [out] acquired_data Структура, в которую записываются результаты измерений
  *
- * \return Полученные результаты измерений
+ * \return Если измерение проведено успешно - true. В противном случае - false, а
+ * структура не содержит точек.
  *
  * **Пример**
  * \code
@@ -671,142 +1063,227 @@ bool DeviceSet::is_using_ext_gen() const {
  * device_set.set_power(0.0);
  * device_set.set_freq_range(1.2e9, 2.4e9, 101);
  *
- * data_t acquired_data = device_set.get_data({2, 4, 5});   // Сбор данных для второго, четвёртого и пятого портов
+ * data_t acquired_data{};
+ * device_set.get_data({2, 4, 5}, acquired_data);    // Сбор данных для второго, четвёртого и пятого портов
  * \endcode
  */
-data_t DeviceSet::get_data(std::vector<int> port_list) {
+bool DeviceSet::get_data(const std::vector<int> &port_list, data_t &acquired_data) {
     if (stop_requested) {
         logger::log(LEVEL_WARN, "Device set stops measuring");
         stop_requested = false;
+        abort_signal->reset();
 
-        return data_t{};
+        acquired_data.reset(port_list.size());
+        return false;
     }
 
     logger::log(LEVEL_TRACE, "Preparing to acquire data");
-    data_t acquired_data{};
+    acquired_data.reset(port_list.size());
 
-    try {
+    std::future<void> traces = vna->submit([this, &port_list]() {
         vna->create_traces(port_list, using_ext_gen);
-        /**
-        if (!traces_configured) {
-            vna->create_traces(port_list, using_ext_gen);
-            traces_configured = true;
+    });
+
+    bool gen_enabled = true;
+
+    if (using_ext_gen) {
+        // Внешний генератор включается, пока ВАЦ создаёт трассы
+        try {
+            ext_gen->rf_on();
+        } catch (const antestl_exception &exception) {
+            gen_enabled = false;
         }
-        */
+    }
 
+    try {
+        traces.get();
         logger::log(LEVEL_TRACE, "Traces created");
-    } catch (int error_code) {
+    } catch (const antestl_exception &exception) {
         logger::log(LEVEL_ERROR, "Can't create traces");
-        return acquired_data;
+        acquired_data.reset(port_list.size());
+        return false;
     }
 
-    for (int port_pos = 0; port_pos < port_list.size(); ++port_pos) {
-        if (stop_requested) {
-            logger::log(LEVEL_WARN, "Device set stops measuring");
-            stop_requested = false;
+    if (!gen_enabled) {
+        logger::log(LEVEL_ERROR, "Can't enable source port");
+        acquired_data.reset(port_list.size());
+        return false;
+    }
 
-            return data_t{};
+    try {
+        if (!using_ext_gen && meas_type == MEAS_TRANSITION) {
+            vna->rf_on(vna->get_source_port());
+        } else if (!using_ext_gen) {
+            vna->rf_on(port_list);
         }
 
-        int port_num = port_list[port_pos];
-        logger::log(LEVEL_TRACE, "Port = {}", port_num);
+        logger::log(LEVEL_TRACE, "Source ports enabled");
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't enable source port");
+        acquired_data.reset(port_list.size());
+        return false;
+    }
 
-        if (meas_type == MEAS_TRANSITION && port_pos == 0) {
-            try {
-                if (using_ext_gen) {
-                    ext_gen->rf_on();
-                } else {
-                    vna->rf_on(vna->get_source_port());
-                }
+    try {
+        vna->error_checkpoint();
 
-                logger::log(LEVEL_TRACE, "Source port enabled");
-            } catch (int error_code) {
-                logger::log(LEVEL_ERROR, "Can't enable source port");
-                return acquired_data;
-            }
-        } else if (meas_type == MEAS_REFLECTION) {
-            try {
-                if (using_ext_gen) {
-                    ext_gen->rf_on();
-                } else {
-                    vna->rf_on(port_num);
-                }
+        vna->trigger();
+        vna->init();
 
-                logger::log(LEVEL_TRACE, "Port {} enabled", port_num);
-            } catch (int error_code) {
-                logger::log(LEVEL_ERROR, "Can't enable port {}", port_num);
-                return acquired_data;
-            }
+        logger::log(LEVEL_TRACE, "Measurements restarted");
+    } catch (const antestl_exception &exception) {
+        // Прерванное измерение уже обработало запрос остановки
+        if (exception.error_code() == ABORTED_CODE) {
+            stop_requested = false;
+        } else {
+            logger::log(LEVEL_ERROR, "Can't restart measurement");
         }
 
-        if ((port_pos == 0 && meas_type == MEAS_TRANSITION) || meas_type == MEAS_REFLECTION) {
-            try {
-                vna->trigger();
-                vna->init();
+        acquired_data.reset(port_list.size());
+        return false;
+    }
 
-                logger::log(LEVEL_TRACE, "Measurements restarted");
-            } catch (int error_code) {
-                logger::log(LEVEL_ERROR, "Can't restart measurement");
-                return acquired_data;
-            }
-        }
+    std::future<void> transfer = vna->submit([this, &port_list, &acquired_data]() {
+        vna->get_data_list((int) port_list.size(), acquired_data.port_data_list);
+    });
 
-        try {
-            acquired_data.insert_iq_port_data(vna->get_data(port_pos));
-            logger::log(LEVEL_TRACE, "Data for port {} acquired", port_num);
-        } catch (int error_code) {
-            logger::log(LEVEL_ERROR, "Can't acquire data for port {} from VNA", port_num);
-            return acquired_data;
-        }
+    // Углы осей ОПУ читаются, пока ВАЦ передаёт данные
+    try {
+        get_current_angles(acquired_data.angle_list);
+    } catch (...) {
+        transfer.wait();
+        throw;
+    }
 
-        if (meas_type == MEAS_TRANSITION && port_pos == port_list.size() - 1) {
-            try {
-                if (using_ext_gen) {
-                    ext_gen->rf_off();
-                } else {
-                    vna->rf_off(vna->get_source_port());
-                }
+    try {
+        transfer.get();
 
-                logger::log(LEVEL_TRACE, "Source port disabled");
-            } catch (int error_code) {
-                logger::log(LEVEL_ERROR, "Can't disable source port");
-                return acquired_data;
-            }
-        } else if (meas_type == MEAS_REFLECTION) {
-            try {
-                if (using_ext_gen) {
-                    ext_gen->rf_off();
-                } else {
-                    vna->rf_off(port_num);
-                }
+        logger::log(LEVEL_TRACE, "Data for {} ports acquired", port_list.size());
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't acquire data from VNA");
+        acquired_data.reset(port_list.size());
+        return false;
+    }
 
-                logger::log(LEVEL_TRACE, "Port {} disabled", port_num);
-            } catch (int error_code) {
-                logger::log(LEVEL_ERROR, "Can't disable port {}", port_num);
-                return acquired_data;
+    try {
+        if (using_ext_gen) {
+            if (ext_gen->get_sweep_mode() == GEN_SWEEP_STEP) {
+                ext_gen->rf_off();
             }
+        } else if (meas_type == MEAS_TRANSITION) {
+            vna->rf_off(vna->get_source_port());
+        } else {
+            vna->rf_off(port_list);
         }
-    }
 
-    acquired_data.insert_angles(get_current_angles());
+        logger::log(LEVEL_TRACE, "Source ports disabled");
+    } catch (const antestl_exception &exception) {
+        logger::log(LEVEL_ERROR, "Can't disable source port");
+        acquired_data.reset(port_list.size());
+        return false;
+    }
 
     if (using_ext_gen) {
         acquired_data.insert_freq(get_current_freq());
     } else {
-        acquired_data.insert_freq_list(get_freq_list());
+        const std::vector<double> &freq_list = get_freq_list();
+        acquired_data.freq_list.assign(freq_list.begin(), freq_list.end());
     }
 
     logger::log(LEVEL_DEBUG, "Data acquired");
 
+    return true;
+}
+
+/**
+ * \brief Метод, осуществляющий проведение измерения и получение результатов
+ * измерения в новой структуре
+ *
+ * \param [in] port_list Список портов, для которых требуется провести измерение
+ *
+ * \return Полученные результаты измерений
+ *
+ * **Пример**
+ * \code
+ * data_t acquired_data = device_set.get_data({2, 4, 5});   // Сбор данных для второго, четвёртого и пятого портов
+ * \endcode
+ */
+data_t DeviceSet::get_data(const std::vector<int> &port_list) {
+    data_t acquired_data{};
+    get_data(port_list, acquired_data);
+
     return acquired_data;
 }
 
+/**
+ * \brief Проводит несколько измерений подряд и усредняет полученные квадратуры
+ *
+ * Квадратуры усредняются как комплексные числа, поэтому в результате
+ * уменьшается шум, а не только его модуль. Значения углов и частот берутся из
+ * первого измерения. Промежуточные измерения записываются во внутренний буфер,
+ * который используется повторно.
+ *
+ * В режиме GEN_SWEEP_LIST_VNA каждое измерение переводит внешний генератор к
+ * следующей частоте, поэтому в этом режиме усреднение не выполняется.
+ *
+ * \param [in] port_list Список портов, для которых требуется провести измерение
+ * \param [in] average Количество измерений
+ * \param [out] acquired_data Структура, в которую записываются усреднённые данные
+ *
+ * \return Если все измерения проведены успешно - true. В противном случае - false,
+ * а структура не содержит точек.
+ *
+ * **Пример**
+ * \code
+ * DeviceSet device_set();
+ *
+ * device_set.connect(DEVICE_VNA, "m9807a", "TCPIP0::localhost::5025::SOCKET");
+ *
+ * data_t acquired_data{};
+ * device_set.get_averaged_data({2, 4}, 16, acquired_data);     // Среднее по 16 измерениям
+ * \endcode
+ */
+bool DeviceSet::get_averaged_data(const std::vector<int> &port_list, int average, data_t &acquired_data) {
+    if (average > 1 && get_gen_sweep_mode() == GEN_SWEEP_LIST_VNA) {
+        logger::log(LEVEL_ERROR, "Can't average data: VNA triggered frequency list steps external gen on every measurement");
+
+        acquired_data.reset(port_list.size());
+        return false;
+    }
+
+    if (!get_data(port_list, acquired_data)) {
+        return false;
+    }
+
+    for (int num = 1; num < average; ++num) {
+        if (!get_data(port_list, average_buffer) || !acquired_data.accumulate(average_buffer)) {
+            logger::log(LEVEL_ERROR, "Can't average data: measurement {} of {} failed", num + 1, average);
+
+            acquired_data.reset(port_list.size());
+            return false;
+        }
+    }
+
+    if (average > 1) {
+        acquired_data.scale(1.0 / average);
+        logger::log(LEVEL_TRACE, "Data averaged over {} measurements", average);
+    }
+
+    return true;
+}
+
 /**
  * \brief Присваивает флагу stop_request значение true, тем самым, останавливая
  * процес измерения
+ *
+ * Если ВАЦ ожидает завершения измерения, то ожидание прерывается (см.
+ * VnaDevice::set_abort_signal()). Метод вызывается из другого потока, поэтому
+ * он не обращается к объектам устройств, которые в это время могут
+ * подключаться или отключаться.
  */
 void DeviceSet::request_stop() {
     stop_requested = true;
+    abort_signal->request();
 }
 
 /**
@@ -814,4 +1291,5 @@ void DeviceSet::request_stop() {
  */
 void DeviceSet::reset_stop_request() {
     stop_requested = false;
+    abort_signal->reset();
 }
@@ -11,6 +11,10 @@
 #define ANTESTL_BACKEND_DEVICE_SET_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <future>
+#include <memory>
 #include "vna/vna_device.hpp"
 #include "gen/gen_device.hpp"
 #include "rbd/rbd_device.hpp"
@@ -19,6 +23,7 @@
 #include "gen/keysight_gen.hpp"
 #include "rbd/demo_rdb.hpp"
 #include "rbd/tesart_rbd.hpp"
+#include "../utils/complex_utils.hpp"
 
 /// Тип устройства: ВАЦ
 #define DEVICE_VNA  0xD0
@@ -32,68 +37,91 @@
 /// Разделитель строк
 #define ROW_DELIMITER       ";"
 
+/// Стандартное количество знаков после запятой для значений квадратур
+#define DEFAULT_DATA_PRECISION          11
+/// Максимальное количество знаков после запятой для значений квадратур
+#define MAX_DATA_PRECISION              17
+/// Количество знаков после запятой для значений углов и частот
+#define FIXED_DATA_PRECISION            6
+/// Оценка максимальной длины значения угла или частоты
+#define FIXED_NUMBER_MAX_SIZE           24
+/// Количество символов в значении квадратуры, помимо знаков после запятой ("-1.", "E+123")
+#define SCIENTIFIC_NUMBER_EXTRA_SIZE    8
+
+/// Выходные данные: квадратуры
+#define OUTPUT_IQ                       0x00
+/// Выходные данные: модуль в дБ
+#define OUTPUT_DB                       0x01
+/// Выходные данные: фаза в градусах (от -180 до 180)
+#define OUTPUT_PHASE                    0x02
+/// Выходные данные: фаза в градусах без скачков на 360 градусов
+#define OUTPUT_UNWRAPPED_PHASE          0x03
+/// Выходные данные: групповое время запаздывания в секундах
+#define OUTPUT_GROUP_DELAY              0x04
+
 /**
- * \brief Структура, которая является вектором iq с набором методов для работы с ней.
+ * \brief Структура, которая содержит в себе данные, полученные при одиночном вызове
+ * метода get_data().
  *
- * Структура определена для хранения данных измерения, полученных от ВАЦ для порта.
+ * Структура содержит в себе набор объектов для хранения данных, методы для добавления
+ * данных и их преобразования. Данные каждого порта хранятся отдельно, в виде массивов
+ * квадратур.
  */
-struct iq_port_list_t {
-    /// Данные для одного порта
-    iq_port_data_t iq_port_list;
+struct data_t {
+    /// Вектор, который содержит в себе значения углов всех осей ОПУ
+    std::vector<float> angle_list{};
+    /// Вектор, который содержит в себе значение частоты для полученных данных
+    std::vector<double> freq_list{};
 
-    /// Конструктор, в котором на вход поступает объект iq, который добавляется в вектор iq
-    iq_port_list_t(iq iq_item) {
-        insert_item(std::move(iq_item));
-    }
+    /// Вектор, содержащий в себе полученные данные при измерении всех портов ВАЦ
+    std::vector<iq_port_data_t> port_data_list{};
 
-    /**
-     * \brief Метод, добавляющий объект iq в вектор
-     *
-     * \param [in] iq_item Комплексная точка
-     */
-    void insert_item(iq iq_item) {
-        iq_port_list.push_back(std::move(iq_item));
-    }
+    /// Тип выходных данных
+    int output = OUTPUT_IQ;
+    /// Вектор, содержащий в себе вычисленные по квадратурам значения для всех портов ВАЦ
+    std::vector<std::vector<double>> value_list{};
+    /// Вспомогательный массив, который используется при вычислении группового времени запаздывания
+    std::vector<double> buffer{};
 
     /**
-     * \brief Метод, который преобразует вектор iq в строку
+     * \brief Удаляет данные структуры без освобождения памяти
+     *
+     * Количество портов устанавливается равным port_count, а массивы всех портов
+     * очищаются. Память, выделенная под массивы при предыдущих измерениях,
+     * сохраняется, поэтому структура может многократно использоваться при
+     * измерении точек одинакового размера без выделения памяти.
+     *
+     * \param [in] port_count Количество портов ВАЦ
+     *
+     * **Пример**
+     * \code
+     * data_t acquired_data{};
      *
-     * \return Строка, в которой содержатся данные измерения, для порта ВАЦ
+     * while (device_set.next_angle(0) != ANGLE_MOVE_BOUND) {
+     *     device_set.get_data({2, 4}, acquired_data);     // Структура очищается внутри get_data()
+     * }
+     * \endcode
      */
-    std::string to_string() {
-        std::string result{};
+    void reset(size_t port_count) {
+        angle_list.clear();
+        freq_list.clear();
+
+        port_data_list.resize(port_count);
 
-        for (const iq &item : iq_port_list) {
-            result += (result.empty() ? "" : COLUMN_DELIMITER) + item.i + COLUMN_DELIMITER + item.q;
+        for (iq_port_data_t &port_data : port_data_list) {
+            port_data.clear();
         }
 
-        return result;
+        output = OUTPUT_IQ;
     }
-};
-
-/**
- * \brief Структура, которая содержит в себе данные, полученные при одиночном вызове
- * метода get_data().
- *
- * Структура содержит в себе набор объектов для хранения данных, методы для добавления
- * данных и их преобразования.
- */
-struct data_t {
-    /// Вектор, который содержит в себе значение угла для полученных точек
-    std::vector<std::string> angle_list{};
-    /// Вектор, который содержит в себе значение частоты для полученных данных
-    std::vector<double> freq_list{};
-
-    /// Вектор, содержащий в себе полученные данные при измерении всех портов ВАЦ
-    std::vector<iq_port_list_t> iq_data_list{};
 
     /**
      * \brief Добавляет значения углов в соответствующий вектор
      *
      * \param [in] angles Список углов, полученный при проведении измерения
      */
-    void insert_angles(std::string angles) {
-        angle_list.push_back(std::move(angles));
+    void insert_angles(std::vector<float> angles) {
+        angle_list = std::move(angles);
     }
 
     /**
@@ -121,45 +149,318 @@ struct data_t {
      * \param [in] iq_port_data Полученные данные для одного порта ВАЦ
      */
     void insert_iq_port_data(iq_port_data_t iq_port_data) {
-        if (iq_data_list.empty()) {
-            for (const iq &item : iq_port_data) {
-                iq_data_list.push_back(iq_port_list_t(item));
+        port_data_list.push_back(std::move(iq_port_data));
+    }
+
+    /**
+     * \brief Запрос количества точек
+     *
+     * \return Наименьшее количество точек среди всех портов ВАЦ
+     */
+    size_t points() const {
+        if (port_data_list.empty()) {
+            return 0;
+        }
+
+        size_t points = port_data_list[0].size();
+
+        for (const iq_port_data_t &port_data : port_data_list) {
+            points = std::min(points, port_data.size());
+        }
+
+        return points;
+    }
+
+    /**
+     * \brief Прибавляет квадратуры другого измерения к квадратурам данной структуры
+     *
+     * Используется для усреднения нескольких измерений одной точки.
+     *
+     * \param [in] other Данные другого измерения
+     *
+     * \return Если количество портов и точек совпадает - true. В противном случае - false.
+     */
+    bool accumulate(const data_t &other) {
+        if (other.port_data_list.size() != port_data_list.size() || other.points() != points()) {
+            return false;
+        }
+
+        size_t rows = points();
+
+        for (size_t port_pos = 0; port_pos < port_data_list.size(); ++port_pos) {
+            iq_port_data_t &port_data = port_data_list[port_pos];
+            const iq_port_data_t &other_port_data = other.port_data_list[port_pos];
+
+            for (size_t pos = 0; pos < rows; ++pos) {
+                port_data.i[pos] += other_port_data.i[pos];
+                port_data.q[pos] += other_port_data.q[pos];
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Умножает квадратуры всех портов на число
+     *
+     * \param [in] factor Множитель
+     */
+    void scale(double factor) {
+        for (iq_port_data_t &port_data : port_data_list) {
+            complex_utils::scale(port_data.i.data(), port_data.i.size(), factor);
+            complex_utils::scale(port_data.q.data(), port_data.q.size(), factor);
+        }
+    }
+
+    /**
+     * \brief Оставляет только точки с заданными индексами
+     *
+     * Точки переставляются внутри существующих массивов, поэтому дополнительная
+     * память не выделяется.
+     *
+     * \param [in] indices Индексы точек, упорядоченные по возрастанию
+     *
+     * \return Если все индексы меньше количества точек и упорядочены по возрастанию -
+     * true. В противном случае - false, а данные не изменяются.
+     *
+     * **Пример**
+     * \code
+     * data_t acquired_data = device_set.get_data({2});     // 201 точка
+     * acquired_data.select_points({0, 100, 200});           // 3 точки
+     * \endcode
+     */
+    bool select_points(const std::vector<size_t> &indices) {
+        size_t rows = points();
+
+        for (size_t pos = 0; pos < indices.size(); ++pos) {
+            if (indices[pos] >= rows || (pos > 0 && indices[pos] <= indices[pos - 1])) {
+                return false;
             }
-        } else {
-            for (int pos = 0; pos < iq_port_data.size(); ++pos) {
-                iq_data_list[pos].insert_item(iq_port_data[pos]);
+        }
+
+        auto select = [&indices](std::vector<double> &values) {
+            for (size_t pos = 0; pos < indices.size(); ++pos) {
+                values[pos] = values[indices[pos]];
             }
+
+            values.resize(indices.size());
+        };
+
+        if (freq_list.size() > 1) {
+            select(freq_list);
+        }
+
+        for (iq_port_data_t &port_data : port_data_list) {
+            select(port_data.i);
+            select(port_data.q);
         }
+
+        return true;
     }
 
     /**
-     * \brief Преобразует структуру в строку
+     * \brief Вычисляет по квадратурам требуемую величину для всех портов ВАЦ
      *
-     * \return Строка, в которой содержатся данные, полученные при проведении измерения
-     * для всех портов ВАЦ.
+     * После вызова метода append_to() и to_string() вместо пар квадратур выводят
+     * по одному значению величины на каждый порт. Групповое время запаздывания
+     * вычисляется по соседним точкам трассы, поэтому для одиночных точек
+     * (например, при использовании внешнего генератора) оно не вычисляется.
+     *
+     * \param [in] output Тип выходных данных (OUTPUT_IQ, OUTPUT_DB, OUTPUT_PHASE,
+     * OUTPUT_UNWRAPPED_PHASE или OUTPUT_GROUP_DELAY)
+     *
+     * \return Если тип выходных данных известен и величина может быть вычислена - true.
+     * В противном случае - false.
+     *
+     * **Пример**
+     * \code
+     * data_t acquired_data = device_set.get_data({2, 4});
+     *
+     * acquired_data.convert(OUTPUT_DB);
+     * std::string result = acquired_data.to_string();     // "2000000000.000000,-7.65262734510E+00,-8.01223517718E+01;..."
+     * \endcode
      */
-    std::string to_string() {
-        std::string result{};
+    bool convert(int output) {
+        if (output < OUTPUT_IQ || output > OUTPUT_GROUP_DELAY) {
+            return false;
+        }
+
+        this->output = output;
+
+        if (output == OUTPUT_IQ) {
+            return true;
+        }
+
+        size_t rows = points();
 
-        for (int pos = 0; pos < iq_data_list.size(); ++pos) {
-            if (angle_list.size() == 1 && angle_list[0].empty()) {
-                result +=
-                        (result.empty() ? "" : ROW_DELIMITER) +
-                        std::to_string(freq_list.size() > 1 ? freq_list[pos] : freq_list[0]) + COLUMN_DELIMITER +
-                        iq_data_list[pos].to_string();
+        if (output == OUTPUT_GROUP_DELAY && rows < 2) {
+            return false;
+        }
+
+        std::vector<double> single_freq_list{};
+        const double *freq = freq_list.data();
+
+        if (freq_list.size() < rows) {
+            single_freq_list.assign(rows, freq_list.empty() ? 0.0 : freq_list[0]);
+            freq = single_freq_list.data();
+        }
+
+        value_list.resize(port_data_list.size());
+
+        for (size_t port_pos = 0; port_pos < port_data_list.size(); ++port_pos) {
+            const iq_port_data_t &port_data = port_data_list[port_pos];
+            std::vector<double> &values = value_list[port_pos];
+
+            values.resize(rows);
+
+            if (output == OUTPUT_DB) {
+                complex_utils::magnitude_db(port_data.i.data(), port_data.q.data(), values.data(), rows);
             } else {
-                result +=
-                        (result.empty() ? "" : ROW_DELIMITER) +
-                        (angle_list.size() > 1 ? angle_list[pos] : angle_list[0]) + COLUMN_DELIMITER +
-                        std::to_string(freq_list.size() > 1 ? freq_list[pos] : freq_list[0]) + COLUMN_DELIMITER +
-                        iq_data_list[pos].to_string();
+                complex_utils::phase(port_data.i.data(), port_data.q.data(), values.data(), rows);
+
+                if (output != OUTPUT_PHASE) {
+                    complex_utils::unwrap(values.data(), rows);
+                }
+
+                if (output == OUTPUT_GROUP_DELAY) {
+                    buffer.resize(rows);
+                    complex_utils::group_delay(values.data(), freq, buffer.data(), rows);
+
+                    values.swap(buffer);
+                } else {
+                    complex_utils::scale(values.data(), rows, 180.0 / std::numbers::pi);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Добавляет данные структуры в конец строки
+     *
+     * Каждая строка результата содержит значения углов (если ОПУ подключено),
+     * значение частоты и пары квадратур для всех портов ВАЦ. Если была вызвана
+     * функция convert(), то вместо пар квадратур выводится по одному значению
+     * для каждого порта. Если строка, в которую добавляются данные, не пуста,
+     * то перед данными добавляется ROW_DELIMITER.
+     *
+     * Размер результата оценивается заранее, поэтому память выделяется один раз,
+     * а числа записываются прямо в строку с помощью std::to_chars().
+     *
+     * \param [in, out] result Строка, в конец которой добавляются данные
+     * \param [in] precision Количество знаков после запятой для значений квадратур
+     *
+     * \return Если данные были добавлены - true. Если структура не содержит данных - false.
+     */
+    bool append_to(std::string &result, int precision = DEFAULT_DATA_PRECISION) const {
+        size_t rows = points();
+
+        if (freq_list.empty() || rows == 0) {
+            return false;
+        }
+
+        precision = std::clamp(precision, 0, MAX_DATA_PRECISION);
+
+        bool derived = output != OUTPUT_IQ && value_list.size() == port_data_list.size();
+
+        size_t row_size =
+                (angle_list.size() + 1) * (FIXED_NUMBER_MAX_SIZE + 1) +
+                port_data_list.size() * (derived ? 1 : 2) * (precision + SCIENTIFIC_NUMBER_EXTRA_SIZE + 1);
+
+        size_t offset = result.size();
+        result.resize(offset + rows * row_size + 1);
+
+        auto write_number = [&result, &offset](auto value, std::chars_format format, int digits) {
+            while (true) {
+                auto [ptr, error] = std::to_chars(result.data() + offset, result.data() + result.size(), value, format, digits);
+
+                if (error == std::errc()) {
+                    if (format == std::chars_format::scientific) {
+                        std::replace(result.data() + offset, ptr, 'e', 'E');
+                    }
+
+                    offset = ptr - result.data();
+                    return;
+                }
+
+                result.resize(result.size() * 2);
+            }
+        };
+
+        auto write_delimiter = [&result, &offset](const char *delimiter) {
+            if (offset == result.size()) {
+                result.resize(result.size() * 2);
+            }
+
+            result[offset++] = delimiter[0];
+        };
+
+        if (offset != 0) {
+            write_delimiter(ROW_DELIMITER);
+        }
+
+        for (size_t pos = 0; pos < rows; ++pos) {
+            if (pos != 0) {
+                write_delimiter(ROW_DELIMITER);
+            }
+
+            for (float angle : angle_list) {
+                write_number(angle, std::chars_format::fixed, FIXED_DATA_PRECISION);
+                write_delimiter(COLUMN_DELIMITER);
+            }
+
+            write_number(freq_list.size() > 1 ? freq_list[pos] : freq_list[0], std::chars_format::fixed, FIXED_DATA_PRECISION);
+
+            if (derived) {
+                for (const std::vector<double> &values : value_list) {
+                    write_delimiter(COLUMN_DELIMITER);
+                    write_number(values[pos], std::chars_format::scientific, precision);
+                }
+
+                continue;
+            }
+
+            for (const iq_port_data_t &port_data : port_data_list) {
+                write_delimiter(COLUMN_DELIMITER);
+                write_number(port_data.i[pos], std::chars_format::scientific, precision);
+                write_delimiter(COLUMN_DELIMITER);
+                write_number(port_data.q[pos], std::chars_format::scientific, precision);
             }
         }
 
+        result.resize(offset);
+        return true;
+    }
+
+    /**
+     * \brief Преобразует структуру в строку
+     *
+     * \param [in] precision Количество знаков после запятой для значений квадратур
+     *
+     * \return Строка, в которой содержатся данные, полученные при проведении измерения
+     * для всех портов ВАЦ.
+     */
+    std::string to_string(int precision = DEFAULT_DATA_PRECISION) const {
+        std::string result{};
+        append_to(result, precision);
+
         return result;
     }
 };
 
+/**
+ * \brief Структура, которая содержит параметры подключения одного устройства
+ */
+struct connect_request_t {
+    /// Тип устройства (DEVICE_VNA, DEVICE_GEN или DEVICE_RBD)
+    int device_type = DEVICE_VNA;
+    /// Модель устройства
+    std::string device_model{};
+    /// Адрес устройства
+    std::string device_address{};
+};
+
 /**
  * \brief Класс набора устройств, в котором реализованы методы взаимодействия
  * между устройствами
@@ -177,18 +478,38 @@ class DeviceSet {
     /// Флаг, показывающий, используется ли внешний генератор
     bool using_ext_gen = false;
 
-    /// Флаг, показывающий, сконфигурированы ли трассы заранее
-    bool traces_configured = false;
     /// Флаг, показывающий, был ли получен запрос на остановку измерений
-    bool stop_requested = false;
+    std::atomic<bool> stop_requested = false;
+    /// Запрос на прерывание ожидания измерения, который передаётся в драйвер ВАЦ
+    std::shared_ptr<abort_signal_t> abort_signal = std::make_shared<abort_signal_t>();
+
+    /// Частотные точки ВАЦ, вычисленные при последнем вызове get_freq_list()
+    std::vector<double> freq_list{};
+    /// Начальная частота, для которой вычислен вектор freq_list
+    double freq_list_start = 0.0;
+    /// Шаг частоты, для которого вычислен вектор freq_list
+    double freq_list_step = 0.0;
+
+    /// Буфер для промежуточных измерений при усреднении
+    data_t average_buffer{};
 
 public:
     DeviceSet() = default;
 
     bool connect(int device_type, std::string device_model, const std::string &device_address);
+    std::vector<bool> connect(const std::vector<connect_request_t> &request_list);
     void disconnect();
 
-    bool configure(int meas_type, float rbw, int source_port, bool using_ext_gen);
+    bool configure(int meas_type, float rbw, int source_port, bool using_ext_gen, int gen_sweep_mode = GEN_SWEEP_STEP);
+
+    bool set_data_format(int data_format, bool swapped_bytes);
+
+    bool set_completion_mode(int completion);
+    bool set_deferred_errors(bool deferred_errors);
+    bool set_timeout(int timeout_class, int timeout);
+
+    bool set_gen_sweep_mode(int gen_sweep_mode);
+    int get_gen_sweep_mode() const;
 
     bool set_power(float power);
 
@@ -201,7 +522,7 @@ public:
     bool move_to_start_freq();
 
     double get_current_freq();
-    std::vector<double> get_freq_list();
+    const std::vector<double> &get_freq_list();
 
     bool set_angle(float angle, int axis_num);
     bool set_angle_range(float start_angle, float stop_angle, int points, int axis_num);
@@ -211,14 +532,24 @@ public:
 
     bool move_to_start_angle(int axis_num);
 
-    std::string get_current_angles();
+    std::vector<float> get_current_angles();
+    void get_current_angles(std::vector<float> &angle_list);
 
     bool set_path(std::vector<int> path_list);
     int get_vna_switch_module_count();
 
+    int get_vna_port_count();
+    int get_vna_source_port();
+    int get_meas_type() const;
+
     bool is_using_ext_gen() const;
 
-    data_t get_data(std::vector<int> port_list);
+    double get_angle_move_time(float angle_delta, int axis_num);
+    double get_freq_step_time();
+
+    bool get_data(const std::vector<int> &port_list, data_t &acquired_data);
+    data_t get_data(const std::vector<int> &port_list);
+    bool get_averaged_data(const std::vector<int> &port_list, int average, data_t &acquired_data);
 
     void request_stop();
 
@@ -36,6 +36,13 @@
 /// Статус изменения частотной точки: находится на границе допустимых значений
 #define FREQ_MOVE_BOUND             0xF1
 
+/// Режим перестройки частоты: пошаговая установка частоты командами
+#define GEN_SWEEP_STEP              0x00
+/// Режим перестройки частоты: список частот, переход к следующей точке по программному триггеру
+#define GEN_SWEEP_LIST_BUS          0x01
+/// Режим перестройки частоты: список частот, переход к следующей точке по триггеру от ВАЦ
+#define GEN_SWEEP_LIST_VNA          0x02
+
 /**
  * \brief Класс, в котором представлены методы для управления генератором
  */
@@ -60,6 +67,9 @@ protected:
     /// Текущая точка
     int current_point   = DEFAULT_CURRENT_POINT;
 
+    /// Режим перестройки частоты
+    int sweep_mode      = GEN_SWEEP_STEP;
+
 public:
     GenDevice() = default;
 
@@ -154,6 +164,30 @@ public:
      * \return Значение частоты сигнала
      */
     virtual double get_current_freq() {return 0.0;};
+
+    /**
+     * \brief Установка режима перестройки частоты
+     *
+     * \param [in] sweep_mode Режим перестройки частоты (GEN_SWEEP_STEP,
+     * GEN_SWEEP_LIST_BUS или GEN_SWEEP_LIST_VNA)
+     */
+    virtual void set_sweep_mode(int sweep_mode) {};
+
+    /**
+     * \brief Запрос режима перестройки частоты
+     *
+     * \return Режим перестройки частоты
+     */
+    int get_sweep_mode() const {
+        return sweep_mode;
+    }
+
+    /**
+     * \brief Оценка времени перехода к следующей частотной точке
+     *
+     * \return Ориентировочное время перестройки частоты в секундах
+     */
+    virtual double get_retune_time() {return 0.0;};
 };
 
 #endif //ANTESTL_BACKEND_GEN_DEVICE_HPP
@@ -22,6 +22,51 @@
  */
 KeysightGen::KeysightGen(std::string device_address) : GenDevice(std::move(device_address)) {}
 
+/**
+ * \brief Загрузка частотного диапазона в список частот генератора
+ *
+ * Все частотные точки передаются генератору одной командой, после чего
+ * генератор переводится в режим списка. Переход к следующей точке
+ * осуществляется по триггеру: программному (команда "*TRG") в режиме
+ * GEN_SWEEP_LIST_BUS или по внешнему триггеру от ВАЦ в режиме
+ * GEN_SWEEP_LIST_VNA.
+ */
+void KeysightGen::load_list() {
+    std::string freq_list{};
+
+    for (int point = 0; point < points; ++point) {
+        freq_list += std::format("{}{}", point == 0 ? "" : ",", start_freq + point * freq_step);
+    }
+
+    send(":LIST:TYPE LIST");
+    send(":LIST:FREQ {}", freq_list);
+
+    send(":POW:MODE FIX");
+
+    send(":LIST:TRIG:SOUR {}", sweep_mode == GEN_SWEEP_LIST_VNA ? "EXT" : "BUS");
+    send(":TRIG:SOUR IMM");
+    send(":INIT:CONT OFF");
+
+    send_wait(":FREQ:MODE LIST");
+
+    list_loaded = true;
+    logger::log(LEVEL_DEBUG, "Frequency list loaded into generator ({} points)", points);
+}
+
+/**
+ * \brief Перевод генератора из режима списка в режим фиксированной частоты
+ */
+void KeysightGen::unload_list() {
+    if (!list_loaded) {
+        return;
+    }
+
+    send(":ABORT");
+    send_wait(":FREQ:MODE CW");
+
+    list_loaded = false;
+}
+
 /**
  * \brief Сброс настроек
  *
@@ -50,6 +95,8 @@ void KeysightGen::preset() {
  * \endcode
  */
 void KeysightGen::set_freq(double freq) {
+    unload_list();
+
     start_freq = freq;
     stop_freq = freq;
 
@@ -84,6 +131,10 @@ void KeysightGen::set_freq_range(double start_freq, double stop_freq, int points
 
     current_freq = start_freq;
     current_point = 0;
+
+    if (sweep_mode != GEN_SWEEP_STEP) {
+        load_list();
+    }
 }
 
 /**
@@ -114,6 +165,7 @@ void KeysightGen::set_power(float power) {
  */
 void KeysightGen::rf_off() {
     send("OUTPUT:STATE OFF");
+    rf_enabled = false;
 }
 
 /**
@@ -126,12 +178,23 @@ void KeysightGen::rf_off() {
  * \endcode
  */
 void KeysightGen::rf_on() {
+    if (list_loaded && rf_enabled) {
+        return;
+    }
+
     send("OUTPUT:STATE ON");
+    rf_enabled = true;
 }
 
 /**
  * \brief Переход к следующей частотной точке
  *
+ * Если в генератор загружен список частот, то в режиме GEN_SWEEP_LIST_BUS
+ * отправляется только программный триггер с ожиданием завершения перестройки
+ * частоты, а в режиме GEN_SWEEP_LIST_VNA
+ * генератор уже перешёл к следующей точке по триггеру от ВАЦ, поэтому
+ * обновляется только номер текущей точки.
+ *
  * \return Если следующая частотная точка находится в пределах
  * границ изменения, то возвращает FREQ_MOVE_OK. Если точка
  * находится на границе, то возвращает FREQ_MOVE_BOUND.
@@ -151,13 +214,19 @@ int KeysightGen::next_freq() {
         return FREQ_MOVE_BOUND;
     }
 
-    rf_off();
-
     current_freq += freq_step;
     ++current_point;
 
+    if (list_loaded) {
+        if (sweep_mode == GEN_SWEEP_LIST_BUS) {
+            send_wait("*TRG");
+        }
+
+        return FREQ_MOVE_OK;
+    }
+
+    rf_off();
     send_wait(":FREQ {}", current_freq);
-    send(":FREQ?");
 
     return FREQ_MOVE_OK;
 }
@@ -184,6 +253,7 @@ int KeysightGen::prev_freq() {
         return FREQ_MOVE_BOUND;
     }
 
+    unload_list();
     rf_off();
 
     current_freq -= freq_step;
@@ -216,6 +286,13 @@ void KeysightGen::move_to_start_freq() {
     current_freq = start_freq;
     current_point = 0;
 
+    if (list_loaded) {
+        send(":ABORT");
+        send_wait(":INIT");
+
+        return;
+    }
+
     send_wait(":FREQ {}", current_freq);
 }
 
@@ -236,6 +313,7 @@ void KeysightGen::move_to_start_freq() {
  * \endcode
  */
 void KeysightGen::move_to_stop_freq() {
+    unload_list();
     rf_off();
 
     current_freq = stop_freq;
@@ -260,7 +338,47 @@ void KeysightGen::move_to_stop_freq() {
  * \endcode
  */
 double KeysightGen::get_current_freq() {
+    if (list_loaded) {
+        return current_freq;
+    }
+
     std::string current_freq = send(":FREQ?");
     return std::stod(current_freq);
 }
 
+/**
+ * \brief Установка режима перестройки частоты
+ *
+ * В режимах GEN_SWEEP_LIST_BUS и GEN_SWEEP_LIST_VNA весь частотный диапазон
+ * загружается в генератор при вызове set_freq_range(), после чего переход
+ * между точками не требует установки частоты и ожидания её завершения.
+ *
+ * \param [in] sweep_mode Режим перестройки частоты
+ *
+ * **Пример**
+ * \code
+ * GenDevice *gen = new KeysightGen("TCPIP0::localhost::5025::SOCKET");
+ *
+ * gen->set_sweep_mode(GEN_SWEEP_LIST_BUS);
+ * gen->set_freq_range(1.2e9, 2.4e9, 201);
+ * gen->move_to_start_freq();
+ * \endcode
+ */
+void KeysightGen::set_sweep_mode(int sweep_mode) {
+    this->sweep_mode = sweep_mode;
+
+    if (sweep_mode == GEN_SWEEP_STEP) {
+        unload_list();
+    } else if (list_loaded) {
+        send(":LIST:TRIG:SOUR {}", sweep_mode == GEN_SWEEP_LIST_VNA ? "EXT" : "BUS");
+    }
+}
+
+/**
+ * \brief Оценка времени перехода к следующей частотной точке
+ *
+ * \return Ориентировочное время перестройки частоты в секундах
+ */
+double KeysightGen::get_retune_time() {
+    return sweep_mode == GEN_SWEEP_STEP ? KEYSIGHT_GEN_STEP_RETUNE_TIME : KEYSIGHT_GEN_LIST_RETUNE_TIME;
+}
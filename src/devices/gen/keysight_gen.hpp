@@ -11,11 +11,23 @@
 
 #include "gen_device.hpp"
 
+/// Время перестройки частоты командой ":FREQ" с ожиданием завершения, в секундах
+#define KEYSIGHT_GEN_STEP_RETUNE_TIME   0.05
+/// Время перехода к следующей точке загруженного списка частот, в секундах
+#define KEYSIGHT_GEN_LIST_RETUNE_TIME   0.002
+
 /**
  * \brief Класс KeysightGen, в котором определены методы для работы с генераторами
  * Keysight
  */
 class KeysightGen : public GenDevice {
+    /// Флаг, показывающий, загружен ли список частот в генератор
+    bool list_loaded = false;
+    /// Флаг, показывающий, включен ли выход генератора
+    bool rf_enabled = false;
+
+    void load_list();
+    void unload_list();
 
 public:
     KeysightGen() = default;
@@ -38,6 +50,10 @@ public:
     void move_to_stop_freq() override;
 
     double get_current_freq() override;
+
+    void set_sweep_mode(int sweep_mode) override;
+
+    double get_retune_time() override;
 };
 
 
@@ -158,6 +158,29 @@ public:
      * \return Количество осей
      */
     virtual int get_axes_count() {return 0;}
+
+    /**
+     * \brief Оценка времени поворота оси на заданный угол
+     *
+     * Используется для выбора порядка вложенных циклов, поэтому достаточно
+     * приблизительного значения.
+     *
+     * \param [in] angle_delta Угол, на который поворачивается ось
+     * \param [in] axis_num Номер оси
+     *
+     * \return Ориентировочное время поворота в секундах
+     */
+    virtual double get_move_time(float angle_delta, int axis_num) {return 0.0;}
+
+    /**
+     * \brief Изменение таймаута выбранного класса для всех осей
+     *
+     * \param [in] timeout_class Класс таймаута TIMEOUT_*
+     * \param [in] timeout Таймаут в миллисекундах
+     *
+     * \return Если таймаут изменён - true. В противном случае - false.
+     */
+    virtual bool set_timeout(int timeout_class, int timeout) {return true;}
 };
 
 #endif //ANTESTL_BACKEND_RBD_DEVICE_HPP
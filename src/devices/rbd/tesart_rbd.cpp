@@ -6,6 +6,7 @@
  * \date 3 июля 2023
  */
 
+#include <cmath>
 #include "tesart_rbd.hpp"
 #include "../../utils/exceptions.hpp"
 #include "../../utils/string_utils.hpp"
@@ -23,13 +24,13 @@ long long TesartRbd::status(int axis_num) {
     std::stringstream stream{};
     long long answer{};
 
-    axes[axis_num].clear();
+    axes[axis_num]->clear();
 
     try {
-        str_answer = axes[axis_num].send("TRJSTAT\r", true);
+        str_answer = axes[axis_num]->send("TRJSTAT\r", true);
         str_answer = string_utils::lstrip(str_answer, 'H');
     } catch (std::invalid_argument inv_arg) {
-        str_answer = axes[axis_num].send("TRJSTAT\r", true);
+        str_answer = axes[axis_num]->send("TRJSTAT\r", true);
         str_answer = string_utils::lstrip(str_answer, 'H');
     }
 
@@ -72,10 +73,36 @@ long long TesartRbd::status(VisaDevice *axis) {
     return answer;
 }
 
+/**
+ * \brief Подключение и инициализация одной оси
+ *
+ * \param [in] axis Указатель на ось
+ * \param [in] axis_num Номер оси
+ */
+void TesartRbd::init_axis(VisaDevice *axis, int axis_num) {
+    logger::log(LEVEL_TRACE, "Connecting to axis {}", axis_num);
+
+    axis->connect();
+
+    axis->send("PROMPT 0\r");
+    axis->send("CLRFAULT\r");
+    axis->send("EN\r");
+
+    axis->clear();
+    std::this_thread::sleep_for(TESART_RBD_SLEEP_TIME_INIT);
+
+    if (!(status(axis) & BIT_REF_SET)) {
+        axis->send("MH\r");
+    }
+}
+
 /**
  * \brief Конструктор, в который передаётся адрес (или список одресов,
  * разделённых символом ';')
  *
+ * Оси подключаются и инициализируются одновременно, каждая в своём потоке
+ * ввода-вывода, поэтому время подключения не зависит от количества осей.
+ *
  * \param [in] device_addresses адрес оси (список адресов осей)
  *
  * **Пример**
@@ -88,27 +115,34 @@ TesartRbd::TesartRbd(const std::string &device_addresses) {
 
     for (int i = 0; i < address_list.size(); ++i) {
         logger::log(LEVEL_TRACE, "Address [{}] = {}", i, address_list[i]);
+        axes.push_back(std::make_unique<VisaDevice>(address_list[i]));
     }
 
-    for (const std::string &address : address_list) {
-        axes.emplace_back(address);
-
-        logger::log(LEVEL_TRACE, "Connecting to axis {}", axes.size() - 1);
+    speed.assign(axes.size(), TESART_RBD_DEFAULT_SPEED);
 
-        axes[axes.size() - 1].connect();
+    std::vector<std::future<void>> init_list{};
 
-        axes[axes.size() - 1].send("PROMPT 0\r");
-        axes[axes.size() - 1].send("CLRFAULT\r");
-        axes[axes.size() - 1].send("EN\r");
+    for (size_t axis_num = 0; axis_num < axes.size(); ++axis_num) {
+        VisaDevice *axis = axes[axis_num].get();
+        init_list.push_back(axis->submit([this, axis, axis_num]() { init_axis(axis, (int) axis_num); }));
+    }
 
-        axes[axes.size() - 1].clear();
-        std::this_thread::sleep_for(TESART_RBD_SLEEP_TIME_INIT);
+    std::exception_ptr init_error{};
 
-        if (!(status(&axes[axes.size() - 1]) & BIT_REF_SET)) {
-            axes[axes.size() - 1].send("MH\r");
+    for (std::future<void> &init : init_list) {
+        try {
+            init.get();
+        } catch (...) {
+            if (init_error == nullptr) {
+                init_error = std::current_exception();
+            }
         }
     }
 
+    if (init_error != nullptr) {
+        std::rethrow_exception(init_error);
+    }
+
     init_params(axes.size());
 }
 
@@ -132,8 +166,8 @@ TesartRbd::TesartRbd(const std::string &device_addresses) {
 bool TesartRbd::is_connected() {
     bool connected = true;
 
-    for (const VisaDevice &axis : axes) {
-        connected &= axis.is_connected();
+    for (const std::unique_ptr<VisaDevice> &axis : axes) {
+        connected &= axis->is_connected();
     }
 
     return connected;
@@ -162,6 +196,14 @@ bool TesartRbd::is_stopped(int axis_num) {
 /**
  * \brief Поворачивает ось до тех пор, пока она не достигнет требуемого угла
  *
+ * Скорость оси в градусах заранее неизвестна, поэтому время поворота не
+ * ограничивается. Вместо этого во время ожидания опрашивается положение оси
+ * (PFB): если за таймаут класса TIMEOUT_MOTION ось не сдвинулась хотя бы на
+ * TESART_RBD_MIN_PROGRESS градусов, то команда перемещения повторяется
+ * TIMEOUT_RETRY_COUNT раз, после чего ось останавливается и бросается исключение
+ * antestl_exception с кодом TIMEOUT_CODE. По длительности успешного поворота
+ * уточняется скорость оси, которая используется в get_move_time().
+ *
  * \param [in] pos Требуемый угол
  * \param [in] axis_num Номер оси
  *
@@ -174,14 +216,52 @@ bool TesartRbd::is_stopped(int axis_num) {
 void TesartRbd::move(float pos, int axis_num) {
     logger::log(LEVEL_TRACE, "Axis {} angle = {}", axis_num, pos);
 
-    axes[axis_num].send(
-            "ORDER 0 {} {} 8192 {} {} 0 -1 0 0\r",
-            int(pos * SCALE), velocity, acceleration, acceleration);
-    axes[axis_num].send("MOVE 0\r");
+    float start_pos = get_pos(axis_num);
+    auto timeout = std::chrono::milliseconds(axes[axis_num]->get_timeout(TIMEOUT_MOTION));
+
+    for (int attempt = 0; attempt <= TIMEOUT_RETRY_COUNT; ++attempt) {
+        if (attempt > 0) {
+            logger::log(LEVEL_WARN, "Axis {} didn't move towards {} in {} ms, retrying", axis_num, pos, timeout.count());
+        }
+
+        axes[axis_num]->send(
+                "ORDER 0 {} {} 8192 {} {} 0 -1 0 0\r",
+                int(pos * SCALE), velocity, acceleration, acceleration);
+        axes[axis_num]->send("MOVE 0\r");
+
+        auto begin = std::chrono::steady_clock::now();
+        auto last_progress = begin;
+        float last_pos = get_pos(axis_num);
+        bool stopped;
+
+        while (!(stopped = is_stopped(axis_num)) && std::chrono::steady_clock::now() - last_progress < timeout) {
+            std::this_thread::sleep_for(100ms);
+
+            float current_pos = get_pos(axis_num);
+
+            if (std::abs(current_pos - last_pos) >= TESART_RBD_MIN_PROGRESS) {
+                last_pos = current_pos;
+                last_progress = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (stopped) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            double moving_time = elapsed.count() - TESART_RBD_SETTLE_TIME;
+
+            if (attempt == 0 && std::abs(pos - start_pos) >= TESART_RBD_SPEED_MIN_ANGLE && moving_time > 0) {
+                speed[axis_num] = std::abs(pos - start_pos) / moving_time;
+                logger::log(LEVEL_TRACE, "Axis {} speed = {} deg/s", axis_num, speed[axis_num]);
+            }
 
-    while(!is_stopped(axis_num)) {
-        std::this_thread::sleep_for(100ms);
+            return;
+        }
     }
+
+    axes[axis_num]->send("STOP\r");
+
+    logger::log(LEVEL_ERROR, TIMEOUT_MSG);
+    throw antestl_exception(TIMEOUT_MSG, TIMEOUT_CODE);
 }
 
 /**
@@ -197,7 +277,7 @@ void TesartRbd::move(float pos, int axis_num) {
  */
 void TesartRbd::stop() {
     for (int axis_num = 0; axis_num < axes.size(); ++axis_num) {
-        axes[axis_num].send("STOP\r");
+        axes[axis_num]->send("STOP\r");
 
         while (!is_stopped(axis_num)) {
             std::this_thread::sleep_for(50ms);
@@ -395,9 +475,9 @@ float TesartRbd::get_pos(int axis_num) {
     std::string str_answer{};
     float answer{};
 
-    axes[axis_num].clear();
+    axes[axis_num]->clear();
 
-    str_answer = axes[axis_num].send("PFB\r", true);
+    str_answer = axes[axis_num]->send("PFB\r", true);
     answer = stof(str_answer) / SCALE;
 
     return answer;
@@ -426,3 +506,51 @@ float TesartRbd::get_pos(int axis_num) {
 int TesartRbd::get_axes_count() {
     return axes.size();
 }
+
+/**
+ * \brief Оценка времени поворота оси на заданный угол
+ *
+ * Скорость оси в градусах в секунду измеряется при каждом повороте не меньше
+ * чем на TESART_RBD_SPEED_MIN_ANGLE (см. move()), до первого такого поворота
+ * используется TESART_RBD_DEFAULT_SPEED. К времени поворота добавляется время
+ * на разгон, торможение и опрос состояния оси.
+ *
+ * \param [in] angle_delta Угол, на который поворачивается ось
+ * \param [in] axis_num Номер оси
+ *
+ * \return Ориентировочное время поворота в секундах
+ */
+double TesartRbd::get_move_time(float angle_delta, int axis_num) {
+    if (angle_delta == 0) {
+        return 0.0;
+    }
+
+    return std::abs(angle_delta) / speed[axis_num] + TESART_RBD_SETTLE_TIME;
+}
+
+/**
+ * \brief Изменение таймаута выбранного класса для всех осей
+ *
+ * Таймаут класса TIMEOUT_MOTION ограничивает время, в течение которого ось может
+ * не продвигаться к требуемому углу (см. move()).
+ *
+ * \param [in] timeout_class Класс таймаута TIMEOUT_*
+ * \param [in] timeout Таймаут в миллисекундах
+ *
+ * \return Если таймаут изменён для всех осей - true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * RbdDevice *rbd = new TesartRbd("TCPIP0::localhost::5025::SOCKET;TCPIP0::localhost::5026::SOCKET");
+ * rbd->set_timeout(TIMEOUT_MOTION, 5000);
+ * \endcode
+ */
+bool TesartRbd::set_timeout(int timeout_class, int timeout) {
+    bool result = true;
+
+    for (const std::unique_ptr<VisaDevice> &axis : axes) {
+        result &= axis->set_timeout(timeout_class, timeout);
+    }
+
+    return result;
+}
@@ -21,6 +21,15 @@
 
 #define SCALE                           10000
 
+/// Время, затрачиваемое на разгон, торможение и проверку остановки оси, в секундах
+#define TESART_RBD_SETTLE_TIME          0.3
+/// Начальная оценка скорости поворота оси в градусах в секунду (уточняется после поворотов)
+#define TESART_RBD_DEFAULT_SPEED        10.0
+/// Минимальный угол поворота в градусах, по которому уточняется скорость оси
+#define TESART_RBD_SPEED_MIN_ANGLE      1.0
+/// Изменение положения оси в градусах, которое считается продвижением к цели
+#define TESART_RBD_MIN_PROGRESS         0.01
+
 using namespace std::chrono_literals;
 
 /**
@@ -29,13 +38,16 @@ using namespace std::chrono_literals;
  */
 class TesartRbd : public RbdDevice {
     /// Оси ОПУ
-    std::vector<VisaDevice> axes;
+    std::vector<std::unique_ptr<VisaDevice>> axes;
 
-    /// Скорость вращения
+    /// Скорость вращения в единицах команды ORDER
     int velocity = 50;
     /// Ускорение
     int acceleration = 3;
 
+    /// Скорость поворота каждой оси в градусах в секунду, измеренная при последнем повороте
+    std::vector<double> speed;
+
     /**
      * \brief Запрос статуса оси ОПУ по номеру оси
      *
@@ -54,6 +66,8 @@ class TesartRbd : public RbdDevice {
      */
     long long status(VisaDevice *axis);
 
+    void init_axis(VisaDevice *axis, int axis_num);
+
 public:
     TesartRbd() = default;
     explicit TesartRbd(const std::string &device_addresses);
@@ -76,6 +90,10 @@ public:
     float get_pos(int axis_num) override;
 
     int get_axes_count() override;
+
+    double get_move_time(float angle_delta, int axis_num) override;
+
+    bool set_timeout(int timeout_class, int timeout) override;
 };
 
 
@@ -0,0 +1,412 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса SocketTransport
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "socket_transport.hpp"
+#include "../../utils/logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+/// Тип дескриптора сокета
+typedef SOCKET native_socket_t;
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/// Тип дескриптора сокета
+typedef int native_socket_t;
+#endif
+
+/**
+ * \brief Проверка, что операция с неблокирующим сокетом не может быть выполнена
+ * без ожидания
+ *
+ * \return Если последняя ошибка означает, что требуется ожидание - true. В противном
+ * случае - false.
+ */
+static bool would_block() {
+#ifdef _WIN32
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+
+/**
+ * \brief Закрытие сокета
+ *
+ * \param [in] handle Дескриптор сокета
+ */
+static void close_socket(native_socket_t handle) {
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif
+}
+
+/**
+ * \brief Перевод сокета в неблокирующий режим
+ *
+ * \param [in] handle Дескриптор сокета
+ *
+ * \return Если режим установлен - true. В противном случае - false.
+ */
+static bool set_non_blocking(native_socket_t handle) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(handle, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(handle, F_GETFL, 0);
+    return flags >= 0 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+/**
+ * \brief Деструктор, который закрывает сокет
+ */
+SocketTransport::~SocketTransport() {
+    close();
+}
+
+/**
+ * \brief Ожидание готовности сокета к чтению или записи
+ *
+ * \param [in] events События, которые требуется дождаться (POLLIN или POLLOUT)
+ *
+ * \return Если сокет готов - true. Если истёк таймаут или возникла ошибка - false.
+ */
+bool SocketTransport::wait(short events) {
+    pollfd descriptor{};
+    descriptor.fd = (native_socket_t) socket_handle;
+    descriptor.events = events;
+
+    while (true) {
+#ifdef _WIN32
+        int ready = WSAPoll(&descriptor, 1, timeout);
+#else
+        int ready = poll(&descriptor, 1, timeout);
+
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+
+        if (ready <= 0) {
+            logger::log(LEVEL_ERROR, ready == 0 ? "Socket timeout" : "Socket poll failed");
+            return false;
+        }
+
+        return (descriptor.revents & (events | POLLHUP)) != 0 && (descriptor.revents & (POLLERR | POLLNVAL)) == 0;
+    }
+}
+
+/**
+ * \brief Приём очередного блока данных из сокета в буфер receive_buffer
+ *
+ * \return Если данные приняты - true. Если истёк таймаут, соединение закрыто
+ * прибором или возникла ошибка - false.
+ */
+bool SocketTransport::receive() {
+    if (receive_buffer.size() < SOCKET_TRANSPORT_BUFFER_SIZE) {
+        receive_buffer.resize(SOCKET_TRANSPORT_BUFFER_SIZE);
+    }
+
+    received_size = 0;
+    received_pos = 0;
+
+    while (true) {
+        auto length = recv(
+                (native_socket_t) socket_handle, receive_buffer.data(), (int) receive_buffer.size(), 0);
+
+        if (length > 0) {
+            received_size = length;
+            return true;
+        }
+
+        if (length == 0) {
+            logger::log(LEVEL_ERROR, "Socket closed by device");
+            return false;
+        }
+
+        if (!would_block() || !wait(POLLIN)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * \brief Подключение к прибору по TCP
+ *
+ * \param [in] address Адрес прибора вида "TCPIP0::<хост>::<порт>::SOCKET"
+ * \param [in] timeout Таймаут подключения и ожидания данных в миллисекундах
+ * \param [in] termination Символ окончания посылки
+ *
+ * \return Если подключение установлено - true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * SocketTransport transport{};
+ *
+ * if (transport.open("TCPIP0::localhost::5025::SOCKET", 1000, '\n')) {
+ *     transport.write("*IDN?\n", 6);
+ * }
+ * \endcode
+ */
+bool SocketTransport::open(const std::string &address, int timeout, char termination) {
+    close();
+
+    size_t host_begin = address.find(SOCKET_ADDRESS_DELIMITER);
+    size_t port_begin = host_begin == std::string::npos ?
+            std::string::npos : address.find(SOCKET_ADDRESS_DELIMITER, host_begin + 2);
+    size_t port_end = port_begin == std::string::npos ?
+            std::string::npos : address.find(SOCKET_ADDRESS_DELIMITER, port_begin + 2);
+
+    if (port_end == std::string::npos) {
+        logger::log(LEVEL_ERROR, "Wrong socket address {}", address);
+        return false;
+    }
+
+    std::string host = address.substr(host_begin + 2, port_begin - host_begin - 2);
+    std::string port = address.substr(port_begin + 2, port_end - port_begin - 2);
+
+    this->timeout = timeout;
+    this->termination = termination;
+    termination_enabled = true;
+
+#ifdef _WIN32
+    WSADATA wsa_data{};
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        logger::log(LEVEL_ERROR, "Can't initialize Winsock");
+        return false;
+    }
+#endif
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo *address_list = nullptr;
+
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &address_list) != 0) {
+        logger::log(LEVEL_ERROR, "Can't resolve host {}", host);
+
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    for (addrinfo *item = address_list; item != nullptr && socket_handle == -1; item = item->ai_next) {
+        native_socket_t handle = socket(item->ai_family, item->ai_socktype, item->ai_protocol);
+
+#ifdef _WIN32
+        if (handle == INVALID_SOCKET) {
+#else
+        if (handle < 0) {
+#endif
+            continue;
+        }
+
+        socket_handle = (std::intptr_t) handle;
+
+        bool connected = set_non_blocking(handle) &&
+                (connect(handle, item->ai_addr, (int) item->ai_addrlen) == 0 || (would_block() && wait(POLLOUT)));
+
+        if (connected) {
+            int error = 0;
+            socklen_t error_size = sizeof(error);
+
+            getsockopt(handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &error_size);
+            connected = error == 0;
+        }
+
+        if (!connected) {
+            close_socket(handle);
+            socket_handle = -1;
+        }
+    }
+
+    freeaddrinfo(address_list);
+
+    if (socket_handle == -1) {
+        logger::log(LEVEL_ERROR, "Can't connect to {}:{}", host, port);
+
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    int no_delay = 1;
+    setsockopt(
+            (native_socket_t) socket_handle, IPPROTO_TCP, TCP_NODELAY,
+            reinterpret_cast<const char *>(&no_delay), sizeof(no_delay));
+
+    received_size = 0;
+    received_pos = 0;
+
+    return true;
+}
+
+/**
+ * \brief Закрытие сокета
+ */
+void SocketTransport::close() {
+    if (socket_handle == -1) {
+        return;
+    }
+
+    close_socket((native_socket_t) socket_handle);
+    socket_handle = -1;
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/**
+ * \brief Отправка данных на прибор
+ *
+ * Если буфер отправки сокета заполнен, то метод ожидает его освобождения.
+ *
+ * \param [in] data Указатель на данные
+ * \param [in] size Количество байт
+ *
+ * \return Если все данные отправлены - true. В противном случае - false.
+ */
+bool SocketTransport::write(const char *data, size_t size) {
+    if (socket_handle == -1) {
+        return false;
+    }
+
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    size_t sent = 0;
+
+    while (sent < size) {
+        auto length = send((native_socket_t) socket_handle, data + sent, (int) (size - sent), flags);
+
+        if (length > 0) {
+            sent += length;
+        } else if (!would_block() || !wait(POLLOUT)) {
+            logger::log(LEVEL_ERROR, "Can't send data to socket");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Чтение данных от прибора
+ *
+ * Данные выдаются из буфера receive_buffer. Если буфер пуст, то ожидается
+ * следующий блок данных от прибора.
+ *
+ * \param [out] buffer Буфер, в который записываются данные
+ * \param [in] size Размер буфера
+ * \param [out] count Количество записанных в буфер байт
+ *
+ * \return TRANSPORT_READ_END, если получен символ окончания посылки (символ
+ * записывается в буфер), TRANSPORT_READ_MORE, если буфер заполнен, и
+ * TRANSPORT_READ_ERROR, если истёк таймаут или возникла ошибка
+ */
+int SocketTransport::read(char *buffer, size_t size, size_t &count) {
+    count = 0;
+
+    if (socket_handle == -1) {
+        return TRANSPORT_READ_ERROR;
+    }
+
+    while (count < size) {
+        if (received_pos == received_size && !receive()) {
+            return TRANSPORT_READ_ERROR;
+        }
+
+        const char *begin = receive_buffer.data() + received_pos;
+        size_t available = std::min(received_size - received_pos, size - count);
+
+        if (termination_enabled) {
+            const void *end = std::memchr(begin, termination, available);
+
+            if (end != nullptr) {
+                available = static_cast<const char *>(end) - begin + 1;
+
+                std::memcpy(buffer + count, begin, available);
+                count += available;
+                received_pos += available;
+
+                return TRANSPORT_READ_END;
+            }
+        }
+
+        std::memcpy(buffer + count, begin, available);
+        count += available;
+        received_pos += available;
+    }
+
+    return TRANSPORT_READ_MORE;
+}
+
+/**
+ * \brief Изменение таймаута ожидания данных
+ *
+ * \param [in] timeout Таймаут в миллисекундах
+ */
+void SocketTransport::set_timeout(int timeout) {
+    this->timeout = timeout;
+}
+
+/**
+ * \brief Очистка входящего буфера
+ *
+ * Отбрасываются данные, которые были приняты, но не выданы методом read(), а
+ * также данные, которые уже находятся в буфере приёма сокета.
+ */
+void SocketTransport::clear() {
+    received_size = 0;
+    received_pos = 0;
+
+    if (socket_handle == -1) {
+        return;
+    }
+
+    if (receive_buffer.size() < SOCKET_TRANSPORT_BUFFER_SIZE) {
+        receive_buffer.resize(SOCKET_TRANSPORT_BUFFER_SIZE);
+    }
+
+    while (recv((native_socket_t) socket_handle, receive_buffer.data(), (int) receive_buffer.size(), 0) > 0) {}
+}
+
+/**
+ * \brief Включение или отключение завершения чтения по символу окончания посылки
+ *
+ * \param [in] enabled Если true, то чтение завершается символом окончания посылки
+ */
+void SocketTransport::set_termination_enabled(bool enabled) {
+    termination_enabled = enabled;
+}
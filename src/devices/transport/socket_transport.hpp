@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс SocketTransport и набор
+ * констант для работы с ним
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SOCKET_TRANSPORT_HPP
+#define ANTESTL_BACKEND_SOCKET_TRANSPORT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "transport.hpp"
+
+/// Размер буфера, в который принимаются данные из сокета
+#define SOCKET_TRANSPORT_BUFFER_SIZE    65536
+/// Разделитель полей адреса прибора
+#define SOCKET_ADDRESS_DELIMITER        "::"
+
+/**
+ * \brief Класс канала связи, в котором команды SCPI передаются по TCP без
+ * библиотеки VISA
+ *
+ * Используется для адресов вида "TCPIP0::<хост>::<порт>::SOCKET". Сокет работает
+ * в неблокирующем режиме: ожидание данных выполняется с помощью poll() (WSAPoll()
+ * в Windows) с таймаутом, который задаётся при подключении. Алгоритм Нейгла
+ * отключается, чтобы короткие команды отправлялись без задержки.
+ *
+ * Данные читаются из сокета блоками по SOCKET_TRANSPORT_BUFFER_SIZE байт, а
+ * метод read() выдаёт их до символа окончания посылки. Байты, которые пришли
+ * после символа окончания посылки, сохраняются до следующего вызова read().
+ */
+class SocketTransport : public Transport {
+    /// Дескриптор сокета. Если сокет не открыт, то -1.
+    std::intptr_t socket_handle = -1;
+
+    /// Таймаут ожидания данных в миллисекундах
+    int timeout = 0;
+    /// Символ окончания посылки
+    char termination = '\n';
+    /// Флаг, показывающий, завершается ли чтение символом окончания посылки
+    bool termination_enabled = true;
+
+    /// Буфер принятых из сокета данных
+    std::vector<char> receive_buffer{};
+    /// Количество байт в буфере receive_buffer
+    size_t received_size = 0;
+    /// Позиция первого байта в буфере receive_buffer, который ещё не был выдан методом read()
+    size_t received_pos = 0;
+
+    bool wait(short events);
+    bool receive();
+
+public:
+    SocketTransport() = default;
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport &) = delete;
+    SocketTransport &operator=(const SocketTransport &) = delete;
+
+    bool open(const std::string &address, int timeout, char termination) override;
+    void close() override;
+
+    bool write(const char *data, size_t size) override;
+    int read(char *buffer, size_t size, size_t &count) override;
+
+    void set_timeout(int timeout) override;
+    void clear() override;
+    void set_termination_enabled(bool enabled) override;
+};
+
+#endif //ANTESTL_BACKEND_SOCKET_TRANSPORT_HPP
@@ -0,0 +1,543 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для классов
+ * RecordingTransport и ReplayTransport
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "trace_transport.hpp"
+#include "../../utils/logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+/**
+ * \brief Конструктор, в котором задаётся канал связи с прибором и путь к файлу
+ * трассировки
+ *
+ * \param [in] inner Канал связи, через который выполняется обмен с прибором
+ * \param [in] path Путь к файлу трассировки
+ */
+RecordingTransport::RecordingTransport(std::unique_ptr<Transport> inner, std::string path) :
+        inner(std::move(inner)), path(std::move(path)) {}
+
+/**
+ * \brief Деструктор, который закрывает подключение и файл трассировки
+ */
+RecordingTransport::~RecordingTransport() {
+    close();
+}
+
+/**
+ * \brief Запись операции в файл трассировки
+ *
+ * \param [in] type Тип записи TRACE_RECORD_*
+ * \param [in] status Результат операции
+ * \param [in] begin Момент начала операции
+ * \param [in] data Данные операции
+ * \param [in] size Количество байт данных
+ */
+void RecordingTransport::record(uint8_t type, uint8_t status, std::chrono::steady_clock::time_point begin,
+                                const char *data, size_t size) {
+    auto end = std::chrono::steady_clock::now();
+
+    if (!trace_file.is_open()) {
+        return;
+    }
+
+    trace_record_t trace_record{};
+    trace_record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count();
+    trace_record.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    trace_record.size = (uint32_t) size;
+    trace_record.type = type;
+    trace_record.status = status;
+
+    trace_file.write(reinterpret_cast<const char *>(&trace_record), sizeof(trace_record));
+
+    if (size > 0) {
+        trace_file.write(data, (std::streamsize) size);
+    }
+}
+
+/**
+ * \brief Подключение к прибору и создание файла трассировки
+ *
+ * Файл создаётся и при неудачном подключении, чтобы при воспроизведении
+ * ошибка подключения повторилась.
+ *
+ * \param [in] address Адрес прибора
+ * \param [in] timeout Таймаут операций чтения и записи в миллисекундах
+ * \param [in] termination Символ окончания посылки
+ *
+ * \return Если подключение установлено - true. В противном случае - false.
+ */
+bool RecordingTransport::open(const std::string &address, int timeout, char termination) {
+    close();
+
+    origin = std::chrono::steady_clock::now();
+    bool opened = inner->open(address, timeout, termination);
+
+    trace_file.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!trace_file.is_open()) {
+        logger::log(LEVEL_ERROR, "Can't create trace file {}", path);
+        return opened;
+    }
+
+    trace_file_header_t header{};
+    std::memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_FILE_VERSION;
+    header.flags = 0;
+
+    if (opened && inner->supports_srq()) {
+        header.flags |= TRACE_FLAG_SRQ;
+    }
+
+    if (opened && inner->supports_end()) {
+        header.flags |= TRACE_FLAG_END;
+    }
+
+    trace_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    record(TRACE_RECORD_OPEN, opened, origin, address.data(), address.size());
+
+    logger::log(LEVEL_DEBUG, "Recording I/O of {} to {}", address, path);
+    return opened;
+}
+
+/**
+ * \brief Закрытие подключения и файла трассировки
+ */
+void RecordingTransport::close() {
+    inner->close();
+
+    if (trace_file.is_open()) {
+        trace_file.close();
+    }
+}
+
+/**
+ * \brief Отправка данных на прибор с записью команды в файл трассировки
+ *
+ * \param [in] data Указатель на данные
+ * \param [in] size Количество байт
+ *
+ * \return Если все данные отправлены - true. В противном случае - false.
+ */
+bool RecordingTransport::write(const char *data, size_t size) {
+    auto begin = std::chrono::steady_clock::now();
+    bool sent = inner->write(data, size);
+
+    record(TRACE_RECORD_WRITE, sent, begin, data, size);
+    return sent;
+}
+
+/**
+ * \brief Чтение данных от прибора с записью ответа в файл трассировки
+ *
+ * \param [out] buffer Буфер, в который записываются данные
+ * \param [in] size Размер буфера
+ * \param [out] count Количество записанных в буфер байт
+ *
+ * \return TRANSPORT_READ_END, TRANSPORT_READ_MORE или TRANSPORT_READ_ERROR
+ */
+int RecordingTransport::read(char *buffer, size_t size, size_t &count) {
+    auto begin = std::chrono::steady_clock::now();
+    int status = inner->read(buffer, size, count);
+
+    record(TRACE_RECORD_READ, status, begin, buffer, count);
+    return status;
+}
+
+/**
+ * \brief Изменение таймаута операций канала inner
+ *
+ * Изменение таймаута не записывается, так как при воспроизведении таймауты не
+ * используются.
+ *
+ * \param [in] timeout Таймаут в миллисекундах
+ */
+void RecordingTransport::set_timeout(int timeout) {
+    inner->set_timeout(timeout);
+}
+
+/**
+ * \brief Очистка буферов канала с записью операции в файл трассировки
+ */
+void RecordingTransport::clear() {
+    auto begin = std::chrono::steady_clock::now();
+    inner->clear();
+
+    record(TRACE_RECORD_CLEAR, true, begin);
+}
+
+/**
+ * \brief Включение или отключение завершения чтения по символу окончания посылки
+ *
+ * \param [in] enabled Если true, то чтение завершается символом окончания посылки
+ */
+void RecordingTransport::set_termination_enabled(bool enabled) {
+    auto begin = std::chrono::steady_clock::now();
+    inner->set_termination_enabled(enabled);
+
+    record(TRACE_RECORD_TERMINATION, enabled, begin);
+}
+
+/**
+ * \brief Проверка передачи признака конца сообщения (END) каналом inner
+ *
+ * \return Если канал передаёт признак END - true. В противном случае - false.
+ */
+bool RecordingTransport::supports_end() const {
+    return inner->supports_end();
+}
+
+/**
+ * \brief Проверка поддержки запросов обслуживания (SRQ) каналом inner
+ *
+ * \return Если канал позволяет ожидать запрос обслуживания - true. В противном
+ * случае - false.
+ */
+bool RecordingTransport::supports_srq() const {
+    return inner->supports_srq();
+}
+
+/**
+ * \brief Включение очереди запросов обслуживания (SRQ) канала inner
+ *
+ * \return Если очередь включена - true. В противном случае - false.
+ */
+bool RecordingTransport::enable_srq() {
+    return inner->enable_srq();
+}
+
+/**
+ * \brief Ожидание запроса обслуживания (SRQ) с записью времени ожидания в файл
+ * трассировки
+ *
+ * \param [in] timeout Таймаут ожидания в миллисекундах
+ *
+ * \return Если запрос получен - true. В противном случае - false.
+ */
+bool RecordingTransport::wait_srq(int timeout) {
+    auto begin = std::chrono::steady_clock::now();
+    bool received = inner->wait_srq(timeout);
+
+    record(TRACE_RECORD_SRQ, received, begin);
+    return received;
+}
+
+/**
+ * \brief Конструктор, в котором задаётся путь к файлу трассировки
+ *
+ * \param [in] path Путь к файлу трассировки
+ */
+ReplayTransport::ReplayTransport(std::string path) : path(std::move(path)) {}
+
+/**
+ * \brief Загрузка файла трассировки в память
+ *
+ * \return Если файл прочитан и его формат поддерживается - true. В противном
+ * случае - false.
+ */
+bool ReplayTransport::load() {
+    std::ifstream trace_file(path, std::ios::binary);
+
+    if (!trace_file.is_open()) {
+        logger::log(LEVEL_ERROR, "Can't open trace file {}", path);
+        return false;
+    }
+
+    trace_file_header_t header{};
+    trace_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    if (!trace_file || std::memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TRACE_FILE_VERSION) {
+        logger::log(LEVEL_ERROR, "Wrong trace file format {}", path);
+        return false;
+    }
+
+    flags = header.flags;
+    records.clear();
+    offsets.clear();
+    payload.clear();
+
+    trace_record_t trace_record{};
+
+    while (trace_file.read(reinterpret_cast<char *>(&trace_record), sizeof(trace_record))) {
+        offsets.push_back(payload.size());
+        payload.resize(payload.size() + trace_record.size);
+
+        if (trace_record.size > 0 && !trace_file.read(payload.data() + offsets.back(), trace_record.size)) {
+            logger::log(LEVEL_WARN, "Trace file {} is truncated", path);
+
+            offsets.pop_back();
+            break;
+        }
+
+        records.push_back(trace_record);
+    }
+
+    logger::log(LEVEL_DEBUG, "Loaded {} records from trace file {}", records.size(), path);
+    return true;
+}
+
+/**
+ * \brief Получение следующей записи заданного типа
+ *
+ * \param [in] type Тип записи TRACE_RECORD_*
+ * \param [in] required Если true, то отсутствие записи считается расхождением
+ * с трассировкой и выводится в лог. Если false, то операция пропускается.
+ *
+ * \return Указатель на запись. Если следующая запись имеет другой тип - nullptr.
+ */
+const trace_record_t *ReplayTransport::next(uint8_t type, bool required) {
+    if (position < records.size() && records[position].type == type) {
+        return &records[position++];
+    }
+
+    if (required) {
+        if (position < records.size()) {
+            logger::log(LEVEL_ERROR, "Replay of {} diverged at record {}: expected type {}, recorded type {}",
+                        path, position, type, records[position].type);
+        } else {
+            logger::log(LEVEL_ERROR, "Replay of {} reached the end of trace", path);
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * \brief Ожидание окончания записанной длительности операции
+ *
+ * Большая часть задержки выполняется сном потока, а последние
+ * TRACE_SPIN_THRESHOLD_US микросекунд - активным ожиданием, так как точность
+ * сна потока недостаточна для коротких операций.
+ *
+ * \param [in] record Запись трассировки
+ * \param [in] begin Момент начала операции
+ */
+void ReplayTransport::replay_duration(const trace_record_t &record,
+                                      std::chrono::steady_clock::time_point begin) const {
+    auto deadline = begin + std::chrono::nanoseconds(record.duration);
+    auto spin_threshold = std::chrono::microseconds(TRACE_SPIN_THRESHOLD_US);
+    auto remaining = deadline - std::chrono::steady_clock::now();
+
+    if (remaining > spin_threshold) {
+        std::this_thread::sleep_for(remaining - spin_threshold);
+    }
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * \brief Загрузка файла трассировки и воспроизведение подключения к прибору
+ *
+ * \param [in] address Адрес прибора
+ * \param [in] timeout Не используется
+ * \param [in] termination Не используется
+ *
+ * \return Если файл загружен и при записи подключение было установлено - true.
+ * В противном случае - false.
+ */
+bool ReplayTransport::open(const std::string &address, int timeout, char termination) {
+    auto begin = std::chrono::steady_clock::now();
+
+    position = 0;
+    read_offset = 0;
+
+    if (!load()) {
+        return false;
+    }
+
+    const trace_record_t *trace_record = next(TRACE_RECORD_OPEN);
+
+    if (trace_record == nullptr) {
+        return false;
+    }
+
+    std::string_view recorded(payload.data() + offsets[position - 1], trace_record->size);
+
+    if (recorded != address) {
+        logger::log(LEVEL_WARN, "Replaying trace of {} for device {}", recorded, address);
+    }
+
+    replay_duration(*trace_record, begin);
+    return trace_record->status != 0;
+}
+
+/**
+ * \brief Завершение воспроизведения
+ */
+void ReplayTransport::close() {
+    read_offset = 0;
+}
+
+/**
+ * \brief Воспроизведение отправки данных на прибор
+ *
+ * Отправленные данные сравниваются с записанной командой.
+ *
+ * \param [in] data Указатель на данные
+ * \param [in] size Количество байт
+ *
+ * \return Если запись найдена и при записи данные были отправлены - true.
+ * В противном случае - false.
+ */
+bool ReplayTransport::write(const char *data, size_t size) {
+    auto begin = std::chrono::steady_clock::now();
+    const trace_record_t *trace_record = next(TRACE_RECORD_WRITE);
+
+    if (trace_record == nullptr) {
+        return false;
+    }
+
+    std::string_view sent(data, size);
+    std::string_view recorded(payload.data() + offsets[position - 1], trace_record->size);
+
+    if (sent != recorded) {
+        logger::log(LEVEL_WARN, "Command differs from trace: sent {}, recorded {}", sent, recorded);
+    }
+
+    replay_duration(*trace_record, begin);
+    return trace_record->status != 0;
+}
+
+/**
+ * \brief Выдача записанного ответа прибора
+ *
+ * Если буфер меньше записанного ответа, то ответ выдаётся за несколько вызовов,
+ * а задержка воспроизводится только при первом из них.
+ *
+ * \param [out] buffer Буфер, в который записываются данные
+ * \param [in] size Размер буфера
+ * \param [out] count Количество записанных в буфер байт
+ *
+ * \return Записанный результат чтения: TRANSPORT_READ_END, TRANSPORT_READ_MORE
+ * или TRANSPORT_READ_ERROR
+ */
+int ReplayTransport::read(char *buffer, size_t size, size_t &count) {
+    auto begin = std::chrono::steady_clock::now();
+    count = 0;
+
+    if (read_offset == 0) {
+        const trace_record_t *trace_record = next(TRACE_RECORD_READ);
+
+        if (trace_record == nullptr) {
+            return TRANSPORT_READ_ERROR;
+        }
+
+        replay_duration(*trace_record, begin);
+    }
+
+    const trace_record_t &trace_record = records[position - 1];
+
+    count = std::min(size, trace_record.size - read_offset);
+    std::memcpy(buffer, payload.data() + offsets[position - 1] + read_offset, count);
+
+    read_offset += count;
+
+    if (read_offset < trace_record.size) {
+        return TRANSPORT_READ_MORE;
+    }
+
+    read_offset = 0;
+    return trace_record.status;
+}
+
+/**
+ * \brief Изменение таймаута операций
+ *
+ * \param [in] timeout Не используется, так как длительность операций берётся из
+ * файла трассировки
+ */
+void ReplayTransport::set_timeout(int timeout) {}
+
+/**
+ * \brief Воспроизведение очистки буферов канала
+ *
+ * Ответ, который был выдан не полностью, отбрасывается.
+ */
+void ReplayTransport::clear() {
+    auto begin = std::chrono::steady_clock::now();
+    const trace_record_t *trace_record = next(TRACE_RECORD_CLEAR, false);
+
+    read_offset = 0;
+
+    if (trace_record != nullptr) {
+        replay_duration(*trace_record, begin);
+    }
+}
+
+/**
+ * \brief Воспроизведение включения или отключения завершения чтения по символу
+ * окончания посылки
+ *
+ * \param [in] enabled Не используется, так как ответы выдаются в том виде, в
+ * котором были записаны
+ */
+void ReplayTransport::set_termination_enabled(bool enabled) {
+    auto begin = std::chrono::steady_clock::now();
+    const trace_record_t *trace_record = next(TRACE_RECORD_TERMINATION, false);
+
+    if (trace_record != nullptr) {
+        replay_duration(*trace_record, begin);
+    }
+}
+
+/**
+ * \brief Проверка передачи признака конца сообщения (END) при записи
+ *
+ * \return Если при записи канал передавал признак END - true. В противном
+ * случае - false.
+ */
+bool ReplayTransport::supports_end() const {
+    return (flags & TRACE_FLAG_END) != 0;
+}
+
+/**
+ * \brief Проверка поддержки запросов обслуживания (SRQ) при записи
+ *
+ * \return Если при записи канал поддерживал запросы обслуживания - true.
+ * В противном случае - false.
+ */
+bool ReplayTransport::supports_srq() const {
+    return (flags & TRACE_FLAG_SRQ) != 0;
+}
+
+/**
+ * \brief Включение очереди запросов обслуживания (SRQ)
+ *
+ * Очередь не требуется, так как результаты ожидания читаются из файла трассировки.
+ *
+ * \return Если при записи канал поддерживал запросы обслуживания - true.
+ * В противном случае - false.
+ */
+bool ReplayTransport::enable_srq() {
+    return supports_srq();
+}
+
+/**
+ * \brief Воспроизведение ожидания запроса обслуживания (SRQ)
+ *
+ * \param [in] timeout Не используется
+ *
+ * \return Записанный результат ожидания
+ */
+bool ReplayTransport::wait_srq(int timeout) {
+    auto begin = std::chrono::steady_clock::now();
+    const trace_record_t *trace_record = next(TRACE_RECORD_SRQ);
+
+    if (trace_record == nullptr) {
+        return false;
+    }
+
+    replay_duration(*trace_record, begin);
+    return trace_record->status != 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определены классы RecordingTransport и
+ * ReplayTransport, а также формат файла трассировки обмена с прибором
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_TRACE_TRANSPORT_HPP
+#define ANTESTL_BACKEND_TRACE_TRANSPORT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "transport.hpp"
+
+/// Сигнатура в начале файла трассировки
+#define TRACE_FILE_MAGIC            "ATRC"
+/// Версия формата файла трассировки
+#define TRACE_FILE_VERSION          0x01
+/// Расширение файла трассировки
+#define TRACE_FILE_EXTENSION        ".atrc"
+
+/// Флаг файла трассировки: канал связи поддерживал запросы обслуживания (SRQ)
+#define TRACE_FLAG_SRQ              0x01
+/// Флаг файла трассировки: канал связи передавал признак конца сообщения (END)
+#define TRACE_FLAG_END              0x02
+
+/// Тип записи: подключение к прибору (данные - адрес прибора)
+#define TRACE_RECORD_OPEN           0x00
+/// Тип записи: отправка данных на прибор
+#define TRACE_RECORD_WRITE          0x01
+/// Тип записи: чтение данных от прибора
+#define TRACE_RECORD_READ           0x02
+/// Тип записи: очистка буферов канала
+#define TRACE_RECORD_CLEAR          0x03
+/// Тип записи: включение или отключение завершения чтения по символу окончания посылки
+#define TRACE_RECORD_TERMINATION    0x04
+/// Тип записи: ожидание запроса обслуживания (SRQ)
+#define TRACE_RECORD_SRQ            0x05
+
+/// Интервал до окончания задержки, начиная с которого воспроизведение ожидает без сна (в микросекундах)
+#define TRACE_SPIN_THRESHOLD_US     1000
+
+/**
+ * \brief Заголовок файла трассировки
+ */
+struct trace_file_header_t {
+    /// Сигнатура TRACE_FILE_MAGIC
+    char magic[4];
+    /// Версия формата TRACE_FILE_VERSION
+    uint16_t version;
+    /// Флаги TRACE_FLAG_*
+    uint16_t flags;
+};
+
+/**
+ * \brief Заголовок записи файла трассировки
+ *
+ * После заголовка следуют size байт данных записи (команда, ответ прибора или
+ * адрес прибора).
+ */
+struct trace_record_t {
+    /// Время начала операции в наносекундах от подключения к прибору (монотонные часы)
+    uint64_t timestamp;
+    /// Длительность операции в наносекундах
+    uint64_t duration;
+    /// Количество байт данных записи
+    uint32_t size;
+    /// Тип записи TRACE_RECORD_*
+    uint8_t type;
+    /// Результат операции: для чтения - TRANSPORT_READ_*, для остальных операций - 1 при успехе и 0 при ошибке
+    uint8_t status;
+    /// Зарезервировано
+    uint16_t reserved;
+};
+
+static_assert(sizeof(trace_file_header_t) == 8, "Unexpected trace file header size");
+static_assert(sizeof(trace_record_t) == 24, "Unexpected trace record size");
+
+/**
+ * \brief Класс канала связи, который записывает весь обмен с прибором в файл
+ * трассировки
+ *
+ * Все вызовы передаются каналу связи inner, а каждая операция (подключение,
+ * отправка, чтение, очистка, ожидание SRQ) сохраняется в файл вместе с временем
+ * начала, длительностью и переданными байтами. Файл перезаписывается при каждом
+ * подключении и воспроизводится классом ReplayTransport.
+ */
+class RecordingTransport : public Transport {
+    /// Канал связи, через который выполняется обмен с прибором
+    std::unique_ptr<Transport> inner;
+
+    /// Путь к файлу трассировки
+    std::string path;
+    /// Поток записи файла трассировки
+    std::ofstream trace_file{};
+
+    /// Момент подключения, от которого отсчитывается время записей
+    std::chrono::steady_clock::time_point origin{};
+
+    void record(uint8_t type, uint8_t status, std::chrono::steady_clock::time_point begin,
+                const char *data = nullptr, size_t size = 0);
+
+public:
+    RecordingTransport(std::unique_ptr<Transport> inner, std::string path);
+    ~RecordingTransport() override;
+
+    RecordingTransport(const RecordingTransport &) = delete;
+    RecordingTransport &operator=(const RecordingTransport &) = delete;
+
+    bool open(const std::string &address, int timeout, char termination) override;
+    void close() override;
+
+    bool write(const char *data, size_t size) override;
+    int read(char *buffer, size_t size, size_t &count) override;
+
+    void set_timeout(int timeout) override;
+    void clear() override;
+    void set_termination_enabled(bool enabled) override;
+    bool supports_end() const override;
+
+    bool supports_srq() const override;
+    bool enable_srq() override;
+    bool wait_srq(int timeout) override;
+};
+
+/**
+ * \brief Класс канала связи, который воспроизводит файл трассировки вместо
+ * обмена с прибором
+ *
+ * Операции сопоставляются с записями файла по порядку. На запросы выдаются
+ * записанные ответы прибора, а каждая операция длится столько же, сколько
+ * при записи, поэтому время выполнения заданий совпадает с временем работы
+ * с реальным прибором. Если отправленная команда отличается от записанной, то
+ * в лог выводится предупреждение, а воспроизведение продолжается.
+ */
+class ReplayTransport : public Transport {
+    /// Путь к файлу трассировки
+    std::string path;
+
+    /// Флаги файла трассировки
+    uint16_t flags = 0;
+    /// Записи файла трассировки
+    std::vector<trace_record_t> records{};
+    /// Смещения данных записей в буфере payload
+    std::vector<size_t> offsets{};
+    /// Данные всех записей
+    std::vector<char> payload{};
+
+    /// Индекс следующей записи
+    size_t position = 0;
+    /// Количество уже выданных байт текущей записи чтения
+    size_t read_offset = 0;
+
+    bool load();
+    const trace_record_t *next(uint8_t type, bool required = true);
+    void replay_duration(const trace_record_t &record, std::chrono::steady_clock::time_point begin) const;
+
+public:
+    explicit ReplayTransport(std::string path);
+
+    ReplayTransport(const ReplayTransport &) = delete;
+    ReplayTransport &operator=(const ReplayTransport &) = delete;
+
+    bool open(const std::string &address, int timeout, char termination) override;
+    void close() override;
+
+    bool write(const char *data, size_t size) override;
+    int read(char *buffer, size_t size, size_t &count) override;
+
+    void set_timeout(int timeout) override;
+    void clear() override;
+    void set_termination_enabled(bool enabled) override;
+    bool supports_end() const override;
+
+    bool supports_srq() const override;
+    bool enable_srq() override;
+    bool wait_srq(int timeout) override;
+};
+
+#endif //ANTESTL_BACKEND_TRACE_TRANSPORT_HPP
@@ -0,0 +1,125 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализован выбор канала связи по адресу прибора
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "transport.hpp"
+#include "socket_transport.hpp"
+#include "trace_transport.hpp"
+#include "../../utils/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+#ifdef ANTESTL_WITH_VISA
+#include "visa_transport.hpp"
+#endif
+
+/**
+ * \brief Задание режима трассировки обмена с приборами
+ *
+ * Режим применяется к каналам связи, которые создаются после вызова метода.
+ * Для каждого прибора используется отдельный файл трассировки, имя которого
+ * формируется из адреса прибора. В режиме записи каталог создаётся, если он
+ * не существует.
+ *
+ * \param [in] mode Режим трассировки TRACE_MODE_*
+ * \param [in] directory Каталог файлов трассировки
+ *
+ * **Пример**
+ * \code
+ * Transport::set_trace_mode(TRACE_MODE_RECORD, "traces");
+ * \endcode
+ */
+void Transport::set_trace_mode(int mode, const std::string &directory) {
+    trace_mode = mode;
+    trace_directory = directory;
+
+    if (mode == TRACE_MODE_RECORD && !directory.empty()) {
+        std::error_code error{};
+        std::filesystem::create_directories(directory, error);
+
+        if (error) {
+            logger::log(LEVEL_ERROR, "Can't create trace directory {}", directory);
+        }
+    }
+}
+
+/**
+ * \brief Формирование пути к файлу трассировки прибора
+ *
+ * Символы адреса, которые не являются буквами или цифрами, заменяются на '_'.
+ *
+ * \param [in] resource Адрес прибора
+ *
+ * \return Путь к файлу трассировки
+ */
+std::string Transport::trace_path(const std::string &resource) {
+    std::string name = resource;
+
+    std::replace_if(name.begin(), name.end(), [](unsigned char symbol) {return !std::isalnum(symbol);}, '_');
+
+    return (std::filesystem::path(trace_directory) / (name + TRACE_FILE_EXTENSION)).string();
+}
+
+/**
+ * \brief Создание канала связи, который соответствует адресу прибора
+ *
+ * Для адресов вида "TCPIP0::<хост>::<порт>::SOCKET" создаётся SocketTransport,
+ * который передаёт команды SCPI по TCP без библиотеки VISA. Для остальных адресов
+ * (INSTR, hislip, GPIB, USB) создаётся VisaTransport. Если адрес начинается с
+ * префикса TRANSPORT_VISA_PREFIX, то префикс отбрасывается и используется
+ * библиотека VISA независимо от вида адреса.
+ *
+ * В режиме TRACE_MODE_RECORD канал связи оборачивается в RecordingTransport. В
+ * режиме TRACE_MODE_REPLAY создаётся ReplayTransport, для которого не требуются
+ * ни прибор, ни библиотека VISA.
+ *
+ * \param [in] address Адрес прибора
+ * \param [out] resource Адрес, который передаётся в метод Transport::open()
+ *
+ * \return Канал связи. Если для адреса требуется библиотека VISA, а программа
+ * собрана без неё, то возвращается nullptr.
+ *
+ * **Пример**
+ * \code
+ * std::string resource{};
+ *
+ * auto socket = Transport::create("TCPIP0::localhost::5025::SOCKET", resource);        // SocketTransport
+ * auto visa = Transport::create("VISA::TCPIP0::localhost::5025::SOCKET", resource);    // VisaTransport
+ * \endcode
+ */
+std::unique_ptr<Transport> Transport::create(const std::string &address, std::string &resource) {
+    bool force_visa = address.starts_with(TRANSPORT_VISA_PREFIX);
+    resource = force_visa ? address.substr(std::string(TRANSPORT_VISA_PREFIX).size()) : address;
+
+    if (trace_mode == TRACE_MODE_REPLAY) {
+        logger::log(LEVEL_TRACE, "Using replay transport for {}", resource);
+        return std::make_unique<ReplayTransport>(trace_path(resource));
+    }
+
+    std::unique_ptr<Transport> transport{};
+
+    if (!force_visa && resource.starts_with("TCPIP") && resource.ends_with(TRANSPORT_SOCKET_SUFFIX)) {
+        logger::log(LEVEL_TRACE, "Using socket transport for {}", resource);
+        transport = std::make_unique<SocketTransport>();
+    } else {
+#ifdef ANTESTL_WITH_VISA
+        logger::log(LEVEL_TRACE, "Using VISA transport for {}", resource);
+        transport = std::make_unique<VisaTransport>();
+#else
+        logger::log(LEVEL_ERROR, "Address {} requires VISA, but the backend is built without it", resource);
+        return nullptr;
+#endif
+    }
+
+    if (trace_mode == TRACE_MODE_RECORD) {
+        return std::make_unique<RecordingTransport>(std::move(transport), trace_path(resource));
+    }
+
+    return transport;
+}
@@ -0,0 +1,164 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён интерфейс Transport и набор
+ * констант для работы с ним
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_TRANSPORT_HPP
+#define ANTESTL_BACKEND_TRANSPORT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/// Результат чтения: получен символ окончания посылки или конец сообщения
+#define TRANSPORT_READ_END      0x00
+/// Результат чтения: буфер заполнен, а посылка не закончилась
+#define TRANSPORT_READ_MORE     0x01
+/// Результат чтения: возникла ошибка или истёк таймаут
+#define TRANSPORT_READ_ERROR    0x02
+
+/// Префикс адреса, при котором подключение всегда выполняется через библиотеку VISA
+#define TRANSPORT_VISA_PREFIX   "VISA::"
+/// Окончание адреса прибора, который принимает команды SCPI по TCP
+#define TRANSPORT_SOCKET_SUFFIX "::SOCKET"
+
+/// Режим трассировки: обмен с приборами не записывается
+#define TRACE_MODE_OFF          0x00
+/// Режим трассировки: обмен с приборами записывается в файлы трассировки
+#define TRACE_MODE_RECORD       0x01
+/// Режим трассировки: вместо обмена с приборами воспроизводятся файлы трассировки
+#define TRACE_MODE_REPLAY       0x02
+
+/**
+ * \brief Интерфейс канала связи с прибором
+ *
+ * Канал связи передаёт команды на прибор и читает ответы. Класс VisaDevice
+ * формирует команды и разбирает ответы, а передачу данных выполняет через
+ * реализацию этого интерфейса: SocketTransport (SCPI по TCP без библиотеки VISA)
+ * или VisaTransport (библиотека VISA).
+ *
+ * Режим трассировки задаётся для всех приборов методом set_trace_mode(). В
+ * режиме записи канал связи оборачивается в RecordingTransport, а в режиме
+ * воспроизведения вместо него создаётся ReplayTransport.
+ */
+class Transport {
+    /// Режим трассировки TRACE_MODE_*
+    inline static int trace_mode = TRACE_MODE_OFF;
+    /// Каталог файлов трассировки
+    inline static std::string trace_directory{};
+
+    static std::string trace_path(const std::string &resource);
+
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * \brief Подключение к прибору
+     *
+     * \param [in] address Адрес прибора
+     * \param [in] timeout Таймаут операций чтения и записи в миллисекундах
+     * \param [in] termination Символ окончания посылки
+     *
+     * \return Если подключение установлено - true. В противном случае - false.
+     */
+    virtual bool open(const std::string &address, int timeout, char termination) = 0;
+
+    /**
+     * \brief Отключение от прибора
+     */
+    virtual void close() = 0;
+
+    /**
+     * \brief Отправка данных на прибор
+     *
+     * \param [in] data Указатель на данные
+     * \param [in] size Количество байт
+     *
+     * \return Если все данные отправлены - true. В противном случае - false.
+     */
+    virtual bool write(const char *data, size_t size) = 0;
+
+    /**
+     * \brief Чтение данных от прибора
+     *
+     * Если включено завершение чтения по символу окончания посылки, то чтение
+     * завершается после этого символа (символ записывается в буфер). В противном
+     * случае чтение продолжается до заполнения буфера.
+     *
+     * \param [out] buffer Буфер, в который записываются данные
+     * \param [in] size Размер буфера
+     * \param [out] count Количество записанных в буфер байт
+     *
+     * \return TRANSPORT_READ_END, TRANSPORT_READ_MORE или TRANSPORT_READ_ERROR
+     */
+    virtual int read(char *buffer, size_t size, size_t &count) = 0;
+
+    /**
+     * \brief Изменение таймаута операций чтения и записи
+     *
+     * \param [in] timeout Таймаут в миллисекундах
+     */
+    virtual void set_timeout(int timeout) = 0;
+
+    /**
+     * \brief Очистка входящего и исходящего буферов канала
+     */
+    virtual void clear() = 0;
+
+    /**
+     * \brief Включение или отключение завершения чтения по символу окончания посылки
+     *
+     * \param [in] enabled Если true, то чтение завершается символом окончания посылки
+     */
+    virtual void set_termination_enabled(bool enabled) = 0;
+
+    /**
+     * \brief Проверка передачи признака конца сообщения (END)
+     *
+     * Признак END позволяет завершить чтение без символа окончания посылки,
+     * например при чтении двоичного блока неопределённой длины ("#0").
+     *
+     * \return Если канал передаёт признак END - true. В противном случае - false.
+     */
+    virtual bool supports_end() const {return false;};
+
+    /**
+     * \brief Проверка поддержки запросов обслуживания (SRQ)
+     *
+     * \return Если канал позволяет ожидать запрос обслуживания - true. В противном
+     * случае - false.
+     */
+    virtual bool supports_srq() const {return false;};
+
+    /**
+     * \brief Включение очереди запросов обслуживания (SRQ)
+     *
+     * Очередь включается до отправки первой команды "*OPC", иначе запрос от быстро
+     * завершившегося действия может прийти раньше, чем его начнут ожидать.
+     * Запросы, оставшиеся в очереди, удаляются.
+     *
+     * \return Если очередь включена - true. Если запросы не поддерживаются - false.
+     */
+    virtual bool enable_srq() {return false;};
+
+    /**
+     * \brief Ожидание запроса обслуживания (SRQ) от прибора
+     *
+     * После получения запроса читается байт состояния, что сбрасывает запрос.
+     *
+     * \param [in] timeout Таймаут ожидания в миллисекундах
+     *
+     * \return Если запрос получен - true. Если истёк таймаут или запросы не
+     * поддерживаются - false.
+     */
+    virtual bool wait_srq(int timeout) {return false;};
+
+    static std::unique_ptr<Transport> create(const std::string &address, std::string &resource);
+    static void set_trace_mode(int mode, const std::string &directory = "");
+};
+
+#endif //ANTESTL_BACKEND_TRANSPORT_HPP
@@ -0,0 +1,277 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса VisaTransport
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "visa_transport.hpp"
+#include "../../utils/logger.hpp"
+
+#include <mutex>
+
+/// Мьютекс, который защищает общий менеджер ресурсов
+static std::mutex resource_manager_mutex{};
+/// Общий менеджер ресурсов VISA
+static ViSession shared_resource_manager = VI_NULL;
+/// Количество открытых подключений, которые используют общий менеджер ресурсов
+static int resource_manager_users = 0;
+
+/**
+ * \brief Получение общего менеджера ресурсов VISA
+ *
+ * При первом вызове менеджер ресурсов открывается с помощью viOpenDefaultRM().
+ * Каждому вызову должен соответствовать вызов release_resource_manager().
+ *
+ * \return Идентификатор менеджера ресурсов. Если его не удалось открыть - VI_NULL.
+ */
+ViSession VisaTransport::acquire_resource_manager() {
+    std::lock_guard<std::mutex> lock(resource_manager_mutex);
+
+    if (resource_manager_users == 0 && viOpenDefaultRM(&shared_resource_manager) < VI_SUCCESS) {
+        shared_resource_manager = VI_NULL;
+        return VI_NULL;
+    }
+
+    resource_manager_users++;
+    return shared_resource_manager;
+}
+
+/**
+ * \brief Освобождение общего менеджера ресурсов VISA
+ *
+ * Менеджер ресурсов закрывается, когда его освободило последнее подключение.
+ */
+void VisaTransport::release_resource_manager() {
+    std::lock_guard<std::mutex> lock(resource_manager_mutex);
+
+    if (resource_manager_users > 0 && --resource_manager_users == 0) {
+        viClose(shared_resource_manager);
+        shared_resource_manager = VI_NULL;
+    }
+}
+
+/**
+ * \brief Деструктор, который закрывает подключение
+ */
+VisaTransport::~VisaTransport() {
+    close();
+}
+
+/**
+ * \brief Подключение к прибору через общий менеджер ресурсов VISA
+ *
+ * \param [in] address Адрес прибора в формате VISA
+ * \param [in] timeout Таймаут операций чтения и записи в миллисекундах
+ * \param [in] termination Символ окончания посылки
+ *
+ * \return Если подключение установлено - true. В противном случае - false.
+ */
+bool VisaTransport::open(const std::string &address, int timeout, char termination) {
+    close();
+
+    ViSession resource_manager = acquire_resource_manager();
+
+    if (resource_manager == VI_NULL) {
+        logger::log(LEVEL_ERROR, "Can't open resource manager");
+        return false;
+    }
+
+    if (viOpen(resource_manager, address.c_str(), VI_NULL, VI_NULL, &device) < VI_SUCCESS) {
+        release_resource_manager();
+        return false;
+    }
+
+    opened = true;
+    resource = address;
+
+    if (viSetAttribute(device, VI_ATTR_TMO_VALUE, timeout) < VI_SUCCESS) {
+        logger::log(LEVEL_ERROR, "Can't set timeout");
+
+        close();
+        return false;
+    }
+
+    if (viSetAttribute(device, VI_ATTR_TERMCHAR, termination) < VI_SUCCESS) {
+        logger::log(LEVEL_ERROR, "Can't set termination character");
+
+        close();
+        return false;
+    }
+
+    if (viSetAttribute(device, VI_ATTR_TERMCHAR_EN, true) < VI_SUCCESS) {
+        logger::log(LEVEL_ERROR, "Can't enable termination character");
+
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Закрытие подключения и освобождение общего менеджера ресурсов
+ */
+void VisaTransport::close() {
+    if (opened) {
+        if (srq_enabled) {
+            viDisableEvent(device, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+            srq_enabled = false;
+        }
+
+        viClose(device);
+        release_resource_manager();
+
+        opened = false;
+    }
+}
+
+/**
+ * \brief Отправка данных на прибор с помощью viWrite()
+ *
+ * \param [in] data Указатель на данные
+ * \param [in] size Количество байт
+ *
+ * \return Если все данные отправлены - true. В противном случае - false.
+ */
+bool VisaTransport::write(const char *data, size_t size) {
+    ViUInt32 ret_count = 0;
+    ViStatus status = viWrite(device, reinterpret_cast<ViConstBuf>(data), (ViUInt32) size, &ret_count);
+
+    return status >= VI_SUCCESS && ret_count == size;
+}
+
+/**
+ * \brief Чтение данных от прибора с помощью viRead()
+ *
+ * \param [out] buffer Буфер, в который записываются данные
+ * \param [in] size Размер буфера
+ * \param [out] count Количество записанных в буфер байт
+ *
+ * \return TRANSPORT_READ_END, TRANSPORT_READ_MORE или TRANSPORT_READ_ERROR
+ */
+int VisaTransport::read(char *buffer, size_t size, size_t &count) {
+    ViUInt32 ret_count = 0;
+    ViStatus status = viRead(device, reinterpret_cast<ViPBuf>(buffer), (ViUInt32) size, &ret_count);
+
+    count = ret_count;
+
+    if (status < VI_SUCCESS) {
+        return TRANSPORT_READ_ERROR;
+    }
+
+    return status == VI_SUCCESS_MAX_CNT ? TRANSPORT_READ_MORE : TRANSPORT_READ_END;
+}
+
+/**
+ * \brief Изменение таймаута операций чтения и записи (атрибут VI_ATTR_TMO_VALUE)
+ *
+ * \param [in] timeout Таймаут в миллисекундах
+ */
+void VisaTransport::set_timeout(int timeout) {
+    if (viSetAttribute(device, VI_ATTR_TMO_VALUE, timeout) < VI_SUCCESS) {
+        logger::log(LEVEL_ERROR, "Can't set timeout");
+    }
+}
+
+/**
+ * \brief Очистка буферов прибора с помощью viClear()
+ */
+void VisaTransport::clear() {
+    viClear(device);
+}
+
+/**
+ * \brief Включение или отключение завершения чтения по символу окончания посылки
+ *
+ * \param [in] enabled Если true, то чтение завершается символом окончания посылки
+ */
+void VisaTransport::set_termination_enabled(bool enabled) {
+    viSetAttribute(device, VI_ATTR_TERMCHAR_EN, enabled);
+}
+
+/**
+ * \brief Проверка передачи признака конца сообщения (END)
+ *
+ * В протоколе SOCKET признак END отсутствует, поэтому сообщение может быть
+ * завершено только символом окончания посылки.
+ *
+ * \return Если адрес прибора не является адресом SOCKET - true. В противном случае - false.
+ */
+bool VisaTransport::supports_end() const {
+    return opened && !resource.ends_with(TRANSPORT_SOCKET_SUFFIX);
+}
+
+/**
+ * \brief Проверка поддержки запросов обслуживания (SRQ)
+ *
+ * Приборы с адресами SOCKET не передают запросы обслуживания, так как для этого
+ * в протоколе отсутствует отдельный канал.
+ *
+ * \return Если адрес прибора не является адресом SOCKET - true. В противном случае - false.
+ */
+bool VisaTransport::supports_srq() const {
+    return opened && !resource.ends_with(TRANSPORT_SOCKET_SUFFIX);
+}
+
+/**
+ * \brief Включение очереди событий VI_EVENT_SERVICE_REQ
+ *
+ * Если очередь уже включена, то накопленные в ней события удаляются.
+ *
+ * \return Если очередь включена - true. В противном случае - false.
+ */
+bool VisaTransport::enable_srq() {
+    if (!supports_srq()) {
+        return false;
+    }
+
+    if (srq_enabled) {
+        viDiscardEvents(device, VI_EVENT_SERVICE_REQ, VI_QUEUE);
+        return true;
+    }
+
+    if (viEnableEvent(device, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL) < VI_SUCCESS) {
+        logger::log(LEVEL_ERROR, "Can't enable service request events");
+        return false;
+    }
+
+    srq_enabled = true;
+    return true;
+}
+
+/**
+ * \brief Ожидание запроса обслуживания (SRQ) от прибора
+ *
+ * Очередь событий должна быть включена заранее (см. enable_srq()). После
+ * получения события байт состояния читается с помощью viReadSTB().
+ *
+ * \param [in] timeout Таймаут ожидания в миллисекундах
+ *
+ * \return Если запрос получен - true. В противном случае - false.
+ */
+bool VisaTransport::wait_srq(int timeout) {
+    if (!supports_srq()) {
+        return false;
+    }
+
+    if (!srq_enabled) {
+        logger::log(LEVEL_ERROR, "Service request events are not enabled");
+        return false;
+    }
+
+    ViEventType event_type{};
+    ViEvent event{};
+
+    if (viWaitOnEvent(device, VI_EVENT_SERVICE_REQ, timeout, &event_type, &event) < VI_SUCCESS) {
+        return false;
+    }
+
+    viClose(event);
+
+    ViUInt16 status_byte = 0;
+    viReadSTB(device, &status_byte);
+
+    return true;
+}
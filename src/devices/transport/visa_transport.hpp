@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс VisaTransport
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_VISA_TRANSPORT_HPP
+#define ANTESTL_BACKEND_VISA_TRANSPORT_HPP
+
+#include "transport.hpp"
+#include "visa.h"
+
+/**
+ * \brief Класс канала связи, в котором передача данных выполняется с помощью
+ * библиотеки VISA
+ *
+ * Используется для адресов, которые не поддерживаются SocketTransport (INSTR,
+ * hislip, GPIB, USB), а также для адресов с префиксом TRANSPORT_VISA_PREFIX.
+ * Для всех адресов, кроме SOCKET, поддерживается ожидание запросов обслуживания.
+ *
+ * Все объекты класса используют один менеджер ресурсов VISA на процесс. Он
+ * открывается при первом подключении и закрывается, когда закрыто последнее
+ * подключение.
+ */
+class VisaTransport : public Transport {
+    /// Идентификатор устройства
+    ViSession device{};
+
+    /// Адрес прибора
+    std::string resource{};
+
+    /// Флаг, показывающий, открыто ли подключение
+    bool opened = false;
+    /// Флаг, показывающий, включена ли очередь запросов обслуживания
+    bool srq_enabled = false;
+
+    static ViSession acquire_resource_manager();
+    static void release_resource_manager();
+
+public:
+    VisaTransport() = default;
+    ~VisaTransport() override;
+
+    VisaTransport(const VisaTransport &) = delete;
+    VisaTransport &operator=(const VisaTransport &) = delete;
+
+    bool open(const std::string &address, int timeout, char termination) override;
+    void close() override;
+
+    bool write(const char *data, size_t size) override;
+    int read(char *buffer, size_t size, size_t &count) override;
+
+    void set_timeout(int timeout) override;
+    void clear() override;
+    void set_termination_enabled(bool enabled) override;
+    bool supports_end() const override;
+
+    bool supports_srq() const override;
+    bool enable_srq() override;
+    bool wait_srq(int timeout) override;
+};
+
+#endif //ANTESTL_BACKEND_VISA_TRANSPORT_HPP
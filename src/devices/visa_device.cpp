@@ -10,6 +10,12 @@
 #include "visa_device.hpp"
 #include "../utils/exceptions.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <chrono>
+#include <thread>
+
 
 /**
  * \brief Метод, позволяющий отправить команду на устройство
@@ -25,10 +31,7 @@ int VisaDevice::write(std::string command) {
     logger::log(LEVEL_TRACE, "WRITE: {}", command);
     command += device_config.termination;
 
-    auto command_buffer = reinterpret_cast<ViConstBuf>(command.c_str());
-    status = viWrite(device, command_buffer, command.length(), ret_count);
-
-    if (status < VI_SUCCESS) {
+    if (transport == nullptr || !transport->write(command.data(), command.size())) {
         return FAILURE;
     }
 
@@ -39,32 +42,158 @@ int VisaDevice::write(std::string command) {
  * \brief Метод, позволяющий считать данные с устройства
  *
  * Чтение осуществляется до тех пор, пока не встретится символ, которым
- * заканчивается посылка
+ * заканчивается посылка. Данные читаются в буфер read_buffer, размер которого
+ * сохраняется после предыдущего ответа, поэтому ответ того же размера считывается
+ * за одно чтение из канала связи. Если буфер заполнен, а посылка не закончилась, то
+ * размер буфера удваивается. Обрабатываются только байты, которые фактически
+ * вернул канал связи.
  *
  * \return Возвращает считанные данные без символа конца посылки
  */
 std::string VisaDevice::read() {
-    std::string data{};
-    ViChar buffer[BUFFER_SIZE];
+    if (read_buffer.size() < READ_BUFFER_MIN_SIZE) {
+        read_buffer.resize(READ_BUFFER_MIN_SIZE);
+    }
+
+    size_t received = 0;
+    int read_count = 0;
 
     while (true) {
-        status = viRead(device, reinterpret_cast<ViPBuf>(buffer), BUFFER_SIZE, ret_count);
+        if (received == read_buffer.size()) {
+            read_buffer.resize(read_buffer.size() * 2);
+        }
+
+        size_t count = 0;
+        int status = transport == nullptr ? TRANSPORT_READ_ERROR :
+                transport->read(read_buffer.data() + received, read_buffer.size() - received, count);
 
-        if (status < VI_SUCCESS) {
+        ++read_count;
+
+        if (status == TRANSPORT_READ_ERROR) {
             return std::string{};
         }
 
-        for (char b : buffer) {
-            if (b == device_config.termination) {
-                logger::log(LEVEL_TRACE, "READ: {}", data);
-                return data;
-            }
+        const char *begin = read_buffer.data() + received;
+        const void *termination = std::memchr(begin, device_config.termination, count);
 
-            data.push_back(b);
+        if (termination != nullptr) {
+            received = static_cast<const char *>(termination) - read_buffer.data();
+            break;
         }
 
-        memset(buffer, 0, sizeof(buffer));
+        received += count;
+
+        if (status != TRANSPORT_READ_MORE) {
+            break;
+        }
     }
+
+    std::string data(read_buffer.data(), received);
+    logger::log(LEVEL_TRACE, "READ: {} bytes in {} reads: {}", received, read_count, data);
+
+    return data;
+}
+
+/**
+ * \brief Метод, позволяющий считать с устройства требуемое количество байт
+ *
+ * Чтение повторяется до тех пор, пока не будет получено требуемое количество
+ * байт, так как одно чтение из канала связи может вернуть только часть данных.
+ *
+ * \param [out] buffer Буфер, в который записываются считанные данные
+ * \param [in] size Количество байт, которое требуется считать
+ *
+ * \return Если все данные были считаны, то возвращает true. В противном случае - false.
+ */
+bool VisaDevice::read_exact(char *buffer, size_t size) {
+    size_t received = 0;
+
+    while (received < size) {
+        size_t count = 0;
+
+        if (transport == nullptr || transport->read(buffer + received, size - received, count) == TRANSPORT_READ_ERROR ||
+            count == 0) {
+            return false;
+        }
+
+        received += count;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Метод, позволяющий считать с устройства двоичный блок данных в формате
+ * IEEE 488.2 ("#<n><длина><данные>")
+ *
+ * На время чтения отключается завершение чтения по символу окончания посылки,
+ * так как он может встретиться внутри двоичных данных. Символ окончания посылки,
+ * который следует за блоком, считывается и отбрасывается.
+ *
+ * Блок неопределённой длины ("#0<данные>") завершается признаком END, поэтому он
+ * читается только через каналы, которые передают этот признак (см.
+ * Transport::supports_end()). Для остальных каналов (например, SOCKET) входящий
+ * буфер очищается и возвращается ошибка.
+ *
+ * \return Содержимое блока без заголовка. Если возникла ошибка при чтении, то
+ * возвращает пустой вектор.
+ */
+std::vector<char> VisaDevice::read_block() {
+    std::vector<char> data{};
+    char header[BLOCK_HEADER_MAX_DIGITS + 1]{};
+
+    if (transport == nullptr) {
+        return data;
+    }
+
+    transport->set_termination_enabled(false);
+
+    if (read_exact(header, 2) && header[0] == BLOCK_HEADER_START && header[1] > '0' && header[1] <= '9') {
+        int digits = header[1] - '0';
+
+        if (read_exact(header, digits)) {
+            header[digits] = '\0';
+            data.resize(std::strtoull(header, nullptr, 10));
+
+            char termination{};
+
+            if (!read_exact(data.data(), data.size()) || !read_exact(&termination, 1)) {
+                data.clear();
+            }
+        }
+    } else if (header[0] == BLOCK_HEADER_START && header[1] == '0' && !transport->supports_end()) {
+        // Без признака END конец блока неопределённой длины нельзя отличить от
+        // символа окончания посылки внутри двоичных данных
+        logger::log(LEVEL_ERROR, "Indefinite length block can't be read without END signal");
+        transport->clear();
+    } else if (header[0] == BLOCK_HEADER_START && header[1] == '0') {
+        if (read_buffer.size() < READ_BUFFER_MIN_SIZE) {
+            read_buffer.resize(READ_BUFFER_MIN_SIZE);
+        }
+
+        int status;
+
+        do {
+            size_t count = 0;
+            status = transport->read(read_buffer.data(), read_buffer.size(), count);
+
+            if (status == TRANSPORT_READ_ERROR) {
+                data.clear();
+                break;
+            }
+
+            data.insert(data.end(), read_buffer.data(), read_buffer.data() + count);
+        } while (status == TRANSPORT_READ_MORE);
+
+        if (!data.empty() && data.back() == device_config.termination) {
+            data.pop_back();
+        }
+    }
+
+    transport->set_termination_enabled(true);
+
+    logger::log(LEVEL_TRACE, "READ: block of {} bytes", data.size());
+    return data;
 }
 
 /**
@@ -105,11 +234,16 @@ VisaDevice::VisaDevice(std::string device_address) {
 
 /**
  * \brief Деструктор, который выполняет отключение от прибора
+ *
+ * Перед отключением завершается поток ввода-вывода, чтобы задания из его очереди
+ * не обращались к закрытому каналу связи.
  */
 VisaDevice::~VisaDevice() {
+    actor.reset();
+
     if (connected) {
         clear();
-        viClose(device);
+        transport->close();
 
         connected = false;
     }
@@ -118,9 +252,9 @@ VisaDevice::~VisaDevice() {
 /**
  * \brief Метод, осуществляющий подключение к прибору.
  *
- * Инициализируется менеджер ресурсов, с помощью которого осуществляется
- * подключение к прибору. Если подключение было установлено, то флаг
- * connected становится true. В противном случае - false.
+ * По адресу прибора создаётся канал связи (см. Transport::create()), с помощью
+ * которого осуществляется подключение к прибору. Если подключение было
+ * установлено, то флаг connected становится true. В противном случае - false.
  *
  * **Пример**
  * \code
@@ -133,59 +267,30 @@ VisaDevice::~VisaDevice() {
  * \endcode
  */
 void VisaDevice::connect() {
-    status = viOpenDefaultRM(&resource_manager);
-
-    if (status < VI_SUCCESS) {
-        logger::log(LEVEL_ERROR, "Can't open resource manager");
-
-        connected = false;
-        return;
-    }
-
-    logger::log(LEVEL_TRACE, "Connecting to device with address {}", device_config.address);
-
-    status = viOpen(
-            resource_manager,
-            device_config.address.c_str(),
-            VI_NULL,
-            VI_NULL,
-            &device);
+    std::string resource{};
+    transport = Transport::create(device_config.address, resource);
 
-    if (status < VI_SUCCESS) {
+    if (transport == nullptr) {
         connected = false;
         return;
-    } else {
-        logger::log(LEVEL_DEBUG, "Connected to device with address {}", device_config.address);
     }
 
-    status = viSetAttribute(device, VI_ATTR_TMO_VALUE, DEFAULT_TIMEOUT);
+    logger::log(LEVEL_TRACE, "Connecting to device with address {}", resource);
 
-    if (status < VI_SUCCESS) {
-        logger::log(LEVEL_ERROR, "Can't set timeout");
+    if (!transport->open(resource, device_config.timeout, device_config.termination)) {
+        transport.reset();
 
         connected = false;
         return;
     }
 
-    status = viSetAttribute(device, VI_ATTR_TERMCHAR, DEFAULT_VISA_TERM);
-
-    if (status < VI_SUCCESS) {
-        logger::log(LEVEL_ERROR, "Can't set termination character");
-
-        connected = false;
-        return;
-    }
-
-    status = viSetAttribute(device, VI_ATTR_TERMCHAR_EN, true);
-
-    if (status < VI_SUCCESS) {
-        logger::log(LEVEL_ERROR, "Can't enable termination character");
+    logger::log(LEVEL_DEBUG, "Connected to device with address {}", resource);
+    connected = true;
+    current_timeout = device_config.timeout;
 
-        connected = false;
-        return;
+    if (device_config.completion != COMPLETION_OPC_QUERY) {
+        set_completion_mode(device_config.completion);
     }
-
-    connected = true;
 }
 
 /**
@@ -201,7 +306,9 @@ bool VisaDevice::is_connected() const {
  * \brief Очищает входящий и исходящие буферы устройства
  */
 void VisaDevice::clear() const {
-    viClear(device);
+    if (transport != nullptr) {
+        transport->clear();
+    }
 }
 
 /**
@@ -249,6 +356,76 @@ int VisaDevice::opc() {
     return FAILURE;
 }
 
+/**
+ * \brief Проверка, состоит ли посылка только из запросов
+ *
+ * Посылка делится на команды по символу ';' (кроме символов внутри кавычек).
+ * Посылку, которая состоит только из запросов, можно отправить повторно, а
+ * посылку с действием (например, "INIT;*OPC?") - нельзя, так как действие
+ * будет выполнено ещё раз.
+ *
+ * \param [in] command Посылка
+ *
+ * \return Если каждая команда посылки оканчивается символом '?' - true. В противном
+ * случае - false.
+ */
+static bool is_pure_query(std::string_view command) {
+    bool quoted = false;
+    char last = '\0';
+
+    for (char symbol : command) {
+        if (symbol == '"') {
+            quoted = !quoted;
+        } else if (symbol == ';' && !quoted && last != '?') {
+            return false;
+        }
+
+        if (symbol != ' ') {
+            last = symbol;
+        }
+    }
+
+    return last == '?';
+}
+
+/**
+ * \brief Разбор значения регистра из ответа прибора
+ *
+ * \param [in] answer Ответ прибора (например, "+32" или "0")
+ *
+ * \return Значение регистра. Если ответ не является числом - -1.
+ */
+static int parse_register(std::string_view answer) {
+    if (!answer.empty() && answer.front() == '+') {
+        answer.remove_prefix(1);
+    }
+
+    int value = 0;
+
+    if (answer.empty() || std::from_chars(answer.data(), answer.data() + answer.size(), value).ec != std::errc{}) {
+        return -1;
+    }
+
+    return value;
+}
+
+/**
+ * \brief Отправляет команду "*ESR?" на подключенное устройство и считывает
+ * регистр событий. Чтение регистра событий очищает его.
+ *
+ * \return Значение регистра событий. Если ответ не получен или не является
+ * числом, то возвращает -1 (FAILURE совпадает со значением бита ESR_OPC_BIT).
+ */
+int VisaDevice::esr() {
+    int esr_status = parse_register(query(CMD_ESR));
+
+    if (esr_status < 0) {
+        logger::log(LEVEL_WARN, "No ESR data from device");
+    }
+
+    return esr_status;
+}
+
 /**
  * \brief Отправляет команду "SYSTEM:ERROR?" на подключенное устройство и считывает
  * сведения об ошибках, возникших на устройстве.
@@ -275,15 +452,323 @@ int VisaDevice::err() {
 }
 
 /**
- * \brief Ожидание завершения выполнения команды.
+ * \brief Установка способа ожидания завершения действий прибором
+ *
+ * Для режимов COMPLETION_ESR_POLL и COMPLETION_SRQ на приборе включается бит
+ * ESR_OPC_BIT в маске регистра событий, а для режима COMPLETION_SRQ - также
+ * бит STB_ESB_BIT в маске запроса обслуживания. Если канал связи не поддерживает
+ * запросы обслуживания (например, адрес SOCKET), то вместо COMPLETION_SRQ
+ * устанавливается режим COMPLETION_ESR_POLL.
+ *
+ * \param [in] completion Способ ожидания: COMPLETION_OPC_QUERY, COMPLETION_ESR_POLL
+ * или COMPLETION_SRQ
+ *
+ * \return Если режим установлен - true. Если передан неизвестный режим - false.
  *
- * Цикл внутри метода будет выполняться до тех пор, пока от функции opc()
- * не вернётся ответ OPC_PASS.
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * if (vna.is_connected()) {
+ *     vna.set_completion_mode(COMPLETION_ESR_POLL);
+ *     vna.send_wait("INIT");
+ * }
+ * \endcode
  */
-void VisaDevice::wait() {
+bool VisaDevice::set_completion_mode(int completion) {
+    if (completion != COMPLETION_OPC_QUERY && completion != COMPLETION_ESR_POLL && completion != COMPLETION_SRQ) {
+        logger::log(LEVEL_ERROR, "Unknown completion mode {}", completion);
+        return false;
+    }
+
+    // Очередь запросов включается до отправки первой команды "*OPC"
+    if (completion == COMPLETION_SRQ && (transport == nullptr || !transport->enable_srq())) {
+        logger::log(LEVEL_WARN, "Service requests are not supported for {}, polling ESR instead",
+                    device_config.address);
+        completion = COMPLETION_ESR_POLL;
+    }
+
+    if (completion != COMPLETION_OPC_QUERY) {
+        send(std::format(CMD_ESE, ESR_OPC_BIT));
+        send(std::format(CMD_SRE, completion == COMPLETION_SRQ ? STB_ESB_BIT : 0));
+        esr();
+    }
+
+    device_config.completion = completion;
+    logger::log(LEVEL_DEBUG, "Completion mode {}", completion);
+
+    return true;
+}
+
+/**
+ * \brief Метод, возвращающий текущий способ ожидания завершения действий
+ *
+ * \return COMPLETION_OPC_QUERY, COMPLETION_ESR_POLL или COMPLETION_SRQ
+ */
+int VisaDevice::get_completion_mode() const {
+    return device_config.completion;
+}
+
+/**
+ * \brief Включение или отключение отложенной проверки ошибок
+ *
+ * При отложенной проверке методы send_err() и send_wait_err() не запрашивают
+ * очередь ошибок "SYSTEM:ERROR?" после каждой команды. Очередь ошибок читается
+ * в контрольных точках методом check_errors(). При отключении отложенной
+ * проверки накопленные ошибки проверяются сразу.
+ *
+ * \param [in] deferred_errors Если true, то проверка ошибок откладывается
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * vna.set_deferred_errors(true);
+ *
+ * vna.send_wait_err(":SENSe:SWEep:POINts 201");
+ * vna.send_wait_err(":SENSe:BANDwidth:RESolution 1e3");
+ *
+ * vna.check_errors();
+ * \endcode
+ */
+void VisaDevice::set_deferred_errors(bool deferred_errors) {
+    if (device_config.deferred_errors && !deferred_errors) {
+        device_config.deferred_errors = false;
+        check_errors();
+    }
+
+    device_config.deferred_errors = deferred_errors;
+}
+
+/**
+ * \brief Изменение таймаута одного из классов команд
+ *
+ * Для классов TIMEOUT_QUERY и TIMEOUT_CONFIG задаётся сам таймаут, а для
+ * классов TIMEOUT_SWEEP и TIMEOUT_MOTION - запас, который добавляется к
+ * ожидаемой длительности операции (см. get_timeout()). Таймаут TIMEOUT_QUERY
+ * применяется к каналу связи сразу.
+ *
+ * \param [in] timeout_class Класс таймаута TIMEOUT_*
+ * \param [in] timeout Таймаут в миллисекундах
+ *
+ * \return Если таймаут изменён - true. Если класс неизвестен или таймаут не
+ * положителен - false.
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * vna.set_timeout(TIMEOUT_QUERY, 2000);
+ * vna.set_timeout(TIMEOUT_CONFIG, 60000);
+ * \endcode
+ */
+bool VisaDevice::set_timeout(int timeout_class, int timeout) {
+    if (timeout <= 0) {
+        logger::log(LEVEL_ERROR, "Wrong timeout {} ms", timeout);
+        return false;
+    }
+
+    switch (timeout_class) {
+        case TIMEOUT_QUERY:
+            device_config.timeout = timeout;
+            apply_timeout(timeout);
+            break;
+        case TIMEOUT_CONFIG:
+            device_config.config_timeout = timeout;
+            break;
+        case TIMEOUT_SWEEP:
+            device_config.sweep_timeout = timeout;
+            break;
+        case TIMEOUT_MOTION:
+            device_config.motion_timeout = timeout;
+            break;
+        default:
+            logger::log(LEVEL_ERROR, "Unknown timeout class {}", timeout_class);
+            return false;
+    }
+
+    logger::log(LEVEL_DEBUG, "Timeout of class {} = {} ms", timeout_class, timeout);
+    return true;
+}
+
+/**
+ * \brief Вычисление таймаута для операции выбранного класса
+ *
+ * Для измерения и перемещения таймаут пропорционален ожидаемой длительности
+ * операции: она умножается на TIMEOUT_EXPECTED_FACTOR, после чего добавляется
+ * запас класса. Таймаут любого класса не меньше таймаута TIMEOUT_QUERY.
+ *
+ * \param [in] timeout_class Класс таймаута TIMEOUT_*
+ * \param [in] expected_time Ожидаемая длительность операции в секундах
+ *
+ * \return Таймаут в миллисекундах
+ */
+int VisaDevice::get_timeout(int timeout_class, double expected_time) const {
+    double timeout;
+
+    switch (timeout_class) {
+        case TIMEOUT_CONFIG:
+            timeout = device_config.config_timeout;
+            break;
+        case TIMEOUT_SWEEP:
+            timeout = device_config.sweep_timeout + TIMEOUT_EXPECTED_FACTOR * expected_time * 1e3;
+            break;
+        case TIMEOUT_MOTION:
+            timeout = device_config.motion_timeout + TIMEOUT_EXPECTED_FACTOR * expected_time * 1e3;
+            break;
+        default:
+            timeout = device_config.timeout;
+            break;
+    }
+
+    return (int) std::clamp(timeout, (double) device_config.timeout, (double) INT_MAX);
+}
+
+/**
+ * \brief Изменение таймаута канала связи
+ *
+ * Канал связи перенастраивается, только если таймаут отличается от текущего.
+ *
+ * \param [in] timeout Таймаут в миллисекундах
+ */
+void VisaDevice::apply_timeout(int timeout) {
+    if (timeout == current_timeout) {
+        return;
+    }
+
+    current_timeout = timeout;
+
+    if (transport != nullptr) {
+        transport->set_timeout(timeout);
+    }
+}
+
+/**
+ * \brief Метод, возвращающий значение флага отложенной проверки ошибок
+ *
+ * \return Значение флага deferred_errors
+ */
+bool VisaDevice::is_deferred_errors() const {
+    return device_config.deferred_errors;
+}
+
+/**
+ * \brief Контрольная точка проверки ошибок
+ *
+ * Очередь ошибок прибора читается запросами "SYSTEM:ERROR?", пока она не опустеет
+ * (но не более ERROR_QUEUE_MAX раз). Каждая ошибка выводится в журнал вместе с
+ * посылками, после которых прибор установил биты ошибок в регистре событий.
+ *
+ * \throw antestl_exception с кодом DEVICE_ERROR_CODE, если на приборе возникли ошибки
+ */
+void VisaDevice::check_errors() {
+    std::vector<std::string> error_list{};
+
+    for (int count = 0; count < ERROR_QUEUE_MAX; ++count) {
+        std::string error_info = query(CMD_ERR);
+
+        if (error_info.empty()) {
+            logger::log(LEVEL_WARN, "No error data from device");
+            break;
+        }
+
+        if (error_info == NO_ERROR_STR_KEYSIGHT || error_info == NO_ERROR_STR_PLANAR) {
+            break;
+        }
+
+        error_list.push_back(std::move(error_info));
+    }
+
+    if (error_list.empty()) {
+        error_sources.clear();
+        return;
+    }
+
+    std::string sources{};
+
+    for (const std::string &source : error_sources) {
+        if (!sources.empty()) {
+            sources += " | ";
+        }
+
+        sources += source;
+    }
+
+    for (const std::string &error_info : error_list) {
+        logger::log(LEVEL_ERROR, "{} (sent in: {})", error_info, sources.empty() ? "unknown" : sources);
+    }
+
+    error_sources.clear();
+
+    logger::log(LEVEL_ERROR, DEVICE_ERROR_MSG);
+    throw antestl_exception(DEVICE_ERROR_MSG, DEVICE_ERROR_CODE);
+}
+
+/**
+ * \brief Контрольная точка, в которой проверяются ошибки, если включена отложенная
+ * проверка ошибок
+ *
+ * Вызывается в конце настройки прибора и перед запуском измерения. Если отложенная
+ * проверка отключена, то ошибки уже проверены после каждой команды и метод ничего
+ * не делает.
+ */
+void VisaDevice::error_checkpoint() {
+    if (device_config.deferred_errors) {
+        check_errors();
+    }
+}
+
+/**
+ * \brief Отправка команды с ожиданием завершения действий и чтением регистра событий
+ *
+ * Регистр событий читается в той же передаче данных, что и ожидание: в режиме
+ * COMPLETION_OPC_QUERY отправляется посылка "<команда>;*OPC?;*ESR?", а в режимах
+ * COMPLETION_ESR_POLL и COMPLETION_SRQ регистр событий читается при ожидании.
+ *
+ * \param [in] command Отправляемая команда (не запрос)
+ *
+ * \return Значение регистра событий. Если ответ не удалось разобрать - -1.
+ */
+int VisaDevice::send_wait_esr(std::string command) {
+    TimeoutScope timeout_scope(*this, TIMEOUT_CONFIG);
+
+    if (device_config.completion != COMPLETION_OPC_QUERY) {
+        send(command + ";" + CMD_OPC_SET);
+
+        return device_config.completion == COMPLETION_SRQ ? wait_srq() : wait_esr();
+    }
+
+    std::string data = send(command + ";" + CMD_OPC + ";" + CMD_ESR);
+    size_t delimiter = data.rfind(';');
+
+    if (delimiter == std::string::npos) {
+        wait_opc();
+        return -1;
+    }
+
+    std::string_view opc_info(data.data(), delimiter);
+
+    if (opc_info != OPC_PASS_STR_KEYSIGHT && opc_info != OPC_PASS_STR_PLANAR) {
+        wait_opc();
+    }
+
+    return parse_register(std::string_view(data).substr(delimiter + 1));
+}
+
+/**
+ * \brief Ожидание завершения действий запросами "*OPC?"
+ *
+ * Если прибор отвечает OPC_WAIT, то запрос повторяется. Интервал между
+ * запросами удваивается от POLL_INTERVAL_MIN_US до POLL_INTERVAL_MAX_US.
+ */
+void VisaDevice::wait_opc() {
+    int interval = POLL_INTERVAL_MIN_US;
     int opc_status;
 
-    do {
+    while (true) {
         opc_status = opc();
 
         if (opc_status == FAILURE) {
@@ -291,7 +776,103 @@ void VisaDevice::wait() {
             throw antestl_exception(OPC_ERROR_MSG, OPC_ERROR_CODE);
         }
 
-    } while (opc_status != OPC_PASS);
+        if (opc_status == OPC_PASS) {
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(interval));
+        interval = std::min(interval * 2, POLL_INTERVAL_MAX_US);
+    }
+}
+
+/**
+ * \brief Ожидание установки бита ESR_OPC_BIT в регистре событий
+ *
+ * Перед вызовом на прибор должна быть отправлена команда "*OPC". Регистр
+ * событий опрашивается запросом "*ESR?", интервал между запросами удваивается
+ * от POLL_INTERVAL_MIN_US до POLL_INTERVAL_MAX_US. Ожидание ограничено таймаутом
+ * прибора.
+ *
+ * \return Объединение значений регистра событий, прочитанных во время ожидания
+ */
+int VisaDevice::wait_esr() {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(current_timeout);
+    int interval = POLL_INTERVAL_MIN_US;
+    int esr_accumulated = 0;
+
+    while (true) {
+        int esr_status = esr();
+
+        if (esr_status < 0 || std::chrono::steady_clock::now() > deadline) {
+            logger::log(LEVEL_ERROR, OPC_ERROR_MSG);
+            throw antestl_exception(OPC_ERROR_MSG, OPC_ERROR_CODE);
+        }
+
+        esr_accumulated |= esr_status;
+
+        if (esr_status & ESR_OPC_BIT) {
+            return esr_accumulated;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(interval));
+        interval = std::min(interval * 2, POLL_INTERVAL_MAX_US);
+    }
+}
+
+/**
+ * \brief Ожидание запроса обслуживания после завершения действий
+ *
+ * Перед вызовом на прибор должна быть отправлена команда "*OPC". Во время
+ * ожидания запросы на прибор не отправляются. После получения запроса
+ * регистр событий очищается запросом "*ESR?". Если бит ESR_OPC_BIT не
+ * установлен (запрос вызван другим событием), то ожидание продолжается
+ * опросом регистра событий.
+ *
+ * \return Объединение значений регистра событий, прочитанных во время ожидания
+ */
+int VisaDevice::wait_srq() {
+    if (!transport->wait_srq(current_timeout)) {
+        logger::log(LEVEL_ERROR, OPC_ERROR_MSG);
+        throw antestl_exception(OPC_ERROR_MSG, OPC_ERROR_CODE);
+    }
+
+    int esr_status = esr();
+
+    if (esr_status < 0) {
+        return wait_esr();
+    }
+
+    if (!(esr_status & ESR_OPC_BIT)) {
+        return esr_status | wait_esr();
+    }
+
+    return esr_status;
+}
+
+/**
+ * \brief Ожидание завершения выполнения команды.
+ *
+ * Способ ожидания задаётся методом set_completion_mode(). В режиме
+ * COMPLETION_OPC_QUERY отправляются запросы "*OPC?" до получения ответа
+ * OPC_PASS. В режимах COMPLETION_ESR_POLL и COMPLETION_SRQ на прибор
+ * отправляется команда "*OPC", после чего ожидается установка бита
+ * ESR_OPC_BIT в регистре событий.
+ */
+void VisaDevice::wait() {
+    TimeoutScope timeout_scope(*this, TIMEOUT_CONFIG);
+
+    if (device_config.completion == COMPLETION_OPC_QUERY) {
+        wait_opc();
+        return;
+    }
+
+    send(CMD_OPC_SET);
+
+    if (device_config.completion == COMPLETION_SRQ) {
+        wait_srq();
+    } else {
+        wait_esr();
+    }
 }
 
 /**
@@ -300,6 +881,11 @@ void VisaDevice::wait() {
  * Данный метод позволяет отправить требуемую команду. Если команда оканчивается
  * символом '?' или передан аргумент read_data = true, то ожидается ответ от прибора.
  *
+ * Если на запрос нет ответа за время таймаута, то посылка, состоящая только из
+ * запросов, отправляется повторно, а для посылки с действием (например,
+ * "INIT;*OPC?") ответ ожидается ещё раз без повторной отправки. Если ответ так и
+ * не получен, то бросается исключение antestl_exception с кодом TIMEOUT_CODE.
+ *
  * \param [in] command Отправляемая команда
  * \param [in] read_data Флаг, показывающий, требуется ли ожидать данные от устройства
  *
@@ -325,9 +911,30 @@ std::string VisaDevice::send(std::string command, bool read_data) {
     if (command[command.length() - 1] == '?') {
         data = query(command);
 
+        bool pure_query = is_pure_query(command);
+
+        for (int retry = 0; data.empty() && retry < TIMEOUT_RETRY_COUNT; ++retry) {
+            if (pure_query) {
+                logger::log(LEVEL_WARN, "No answer to \"{}\" from {} in {} ms, retrying",
+                            command, device_config.address, current_timeout);
+
+                clear();
+                data = query(command);
+            } else {
+                // Действие не запускается повторно: ожидается ответ на уже отправленную посылку
+                logger::log(LEVEL_WARN, "No answer to \"{}\" from {} in {} ms, waiting again",
+                            command, device_config.address, current_timeout);
+
+                data = read();
+            }
+        }
+
         if (data.empty()) {
-            logger::log(LEVEL_ERROR, READ_ERROR_MSG);
-            throw antestl_exception(READ_ERROR_MSG, READ_ERROR_CODE);
+            // Опоздавший ответ не должен быть прочитан следующим запросом
+            clear();
+
+            logger::log(LEVEL_ERROR, TIMEOUT_MSG);
+            throw antestl_exception(TIMEOUT_MSG, TIMEOUT_CODE);
         }
     } else {
         if (write(command) == FAILURE) {
@@ -356,6 +963,10 @@ std::string VisaDevice::send(std::string command, bool read_data) {
  * символом '?' или передан флаг read_data = true, то метод ожидает ответ
  * от прибора. В противном случае возвращается пустая строка.
  *
+ * Если команда не является запросом, то она объединяется с командой ожидания
+ * ("*OPC?" или "*OPC", в зависимости от способа ожидания) в одну посылку, что
+ * экономит одну передачу данных между программой и прибором.
+ *
  * \param [in] command Отправляемая команда
  * \param [in] read_data Флаг, показывающий, требуется ли ожидать данные от устройства
  *
@@ -376,10 +987,29 @@ std::string VisaDevice::send(std::string command, bool read_data) {
  * \endcode
  */
 std::string VisaDevice::send_wait(std::string command) {
+    TimeoutScope timeout_scope(*this, TIMEOUT_CONFIG);
     std::string data{};
 
-    data = send(std::move(command));
-    wait();
+    if (command.ends_with('?')) {
+        data = send(std::move(command));
+        wait();
+    } else if (device_config.completion == COMPLETION_OPC_QUERY) {
+        data = send(command + ";" + CMD_OPC);
+
+        if (data != OPC_PASS_STR_KEYSIGHT && data != OPC_PASS_STR_PLANAR) {
+            wait_opc();
+        }
+
+        data.clear();
+    } else {
+        send(command + ";" + CMD_OPC_SET);
+
+        if (device_config.completion == COMPLETION_SRQ) {
+            wait_srq();
+        } else {
+            wait_esr();
+        }
+    }
 
     return data;
 }
@@ -391,6 +1021,8 @@ std::string VisaDevice::send_wait(std::string command) {
  * Метод проверяет наличие ошибок на приборе после выполнения
  * команды. Если строка заканчивается символом '?' или передан
  * флаг read_data = true, то функция ожидает ответ от прибора.
+ * При отложенной проверке ошибок (см. set_deferred_errors()) очередь
+ * ошибок не запрашивается.
  *
  * \param [in] command Отправляемая команда
  * \param [in] read_data Флаг, показывающий, требуется ли ожидать данные от устройства
@@ -414,6 +1046,10 @@ std::string VisaDevice::send_err(std::string command) {
 
     data = send(std::move(command));
 
+    if (device_config.deferred_errors) {
+        return data;
+    }
+
     if (err() == ERRORS) {
         logger::log(LEVEL_ERROR, DEVICE_ERROR_MSG);
         throw antestl_exception(DEVICE_ERROR_MSG, DEVICE_ERROR_CODE);
@@ -432,6 +1068,11 @@ std::string VisaDevice::send_err(std::string command) {
  * символом '?' или был передан флаг read_data = true, то метод ожидает
  * ответ от прибора. В противном случае возвращается пустая строка.
  *
+ * При отложенной проверке ошибок (см. set_deferred_errors()) вместе с ожиданием
+ * завершения действий читается регистр событий. Если в нём установлены биты
+ * ESR_ERROR_BITS, то посылка запоминается, а ошибки выводятся методом
+ * check_errors().
+ *
  * \param [in] command Отправляемая команда
  * \param [in] read_data Флаг, показывающий, требуется ли ожидать данные от устройства
  *
@@ -451,6 +1092,16 @@ std::string VisaDevice::send_err(std::string command) {
 std::string VisaDevice::send_wait_err(std::string command) {
     std::string data{};
 
+    if (device_config.deferred_errors && !command.ends_with('?')) {
+        int esr_status = send_wait_esr(command);
+
+        if ((esr_status < 0 || (esr_status & ESR_ERROR_BITS)) && error_sources.size() < ERROR_SOURCES_MAX) {
+            error_sources.push_back(std::move(command));
+        }
+
+        return data;
+    }
+
     send_wait(std::move(command));
 
     if (err() == ERRORS) {
@@ -460,3 +1111,178 @@ std::string VisaDevice::send_wait_err(std::string command) {
 
     return data;
 }
+
+/**
+ * \brief Отправка запроса на прибор и чтение ответа в виде двоичного блока
+ * данных
+ *
+ * Используется для получения больших массивов данных (например, трасс ВАЦ) в
+ * двоичном формате, что позволяет избежать передачи и разбора текста.
+ *
+ * \param [in] command Отправляемая команда
+ *
+ * \return Содержимое двоичного блока без заголовка
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * if (vna.is_connected()) {
+ *     vna.send(":FORMAT:DATA REAL,64");
+ *     std::vector<char> data = vna.send_block(":CALCULATE:MEASURE1:DATA:SDATA?");
+ * }
+ * \endcode
+ */
+std::vector<char> VisaDevice::send_block(std::string command) {
+    std::vector<char> data{};
+
+    if (write(std::move(command)) == FAILURE) {
+        logger::log(LEVEL_ERROR, WRITE_ERROR_MSG);
+        throw antestl_exception(WRITE_ERROR_MSG, WRITE_ERROR_CODE);
+    }
+
+    data = read_block();
+
+    if (data.empty()) {
+        logger::log(LEVEL_ERROR, READ_ERROR_MSG);
+        throw antestl_exception(READ_ERROR_MSG, READ_ERROR_CODE);
+    }
+
+    return data;
+}
+
+/**
+ * \brief Отправка составного запроса на прибор и чтение ответа в виде
+ * нескольких двоичных блоков данных
+ *
+ * Запросы, объединённые через ';', выполняются прибором за одну транзакцию, а
+ * ответы на них разделяются символом ';'. Каждый блок читается по заголовку,
+ * после чего отбрасывается следующий за ним разделитель или символ окончания
+ * посылки.
+ *
+ * \param [in] command Отправляемая команда
+ * \param [in] block_count Количество блоков в ответе
+ *
+ * \return Содержимое двоичных блоков без заголовков
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * if (vna.is_connected()) {
+ *     vna.send(":FORMAT:DATA REAL,64");
+ *     auto data = vna.send_blocks(":CALCULATE:MEASURE1:DATA:SDATA?;:CALCULATE:MEASURE2:DATA:SDATA?", 2);
+ * }
+ * \endcode
+ */
+std::vector<std::vector<char>> VisaDevice::send_blocks(std::string command, size_t block_count) {
+    std::vector<std::vector<char>> data_list{};
+
+    if (write(std::move(command)) == FAILURE) {
+        logger::log(LEVEL_ERROR, WRITE_ERROR_MSG);
+        throw antestl_exception(WRITE_ERROR_MSG, WRITE_ERROR_CODE);
+    }
+
+    for (size_t block_num = 0; block_num < block_count; ++block_num) {
+        data_list.push_back(read_block());
+
+        if (data_list.back().empty()) {
+            logger::log(LEVEL_ERROR, READ_ERROR_MSG);
+            throw antestl_exception(READ_ERROR_MSG, READ_ERROR_CODE);
+        }
+    }
+
+    return data_list;
+}
+
+/**
+ * \brief Конструктор пустого пакета команд
+ *
+ * \param [in] device Прибор, на который будут отправлены команды
+ */
+CommandBatch::CommandBatch(VisaDevice &device) : device(device) {}
+
+/**
+ * \brief Добавление команды в пакет
+ *
+ * \param [in] command Команда
+ *
+ * \return Ссылка на пакет
+ */
+CommandBatch &CommandBatch::add(std::string_view command) {
+    if (command.empty()) {
+        return *this;
+    }
+
+    if (command.back() == '?') {
+        logger::log(LEVEL_ERROR, "Query {} can't be batched", command);
+        throw antestl_exception(WRITE_ERROR_MSG, WRITE_ERROR_CODE);
+    }
+
+    bool rooted = command.front() == ':' || command.front() == '*';
+
+    if (!commands.empty() && commands.size() + command.size() + 2 > BATCH_MAX_LENGTH) {
+        flush();
+    }
+
+    if (!commands.empty()) {
+        commands += BATCH_DELIMITER;
+    }
+
+    if (!rooted) {
+        commands += ':';
+    }
+
+    commands += command;
+
+    return *this;
+}
+
+/**
+ * \brief Отправка накопленных команд на прибор
+ *
+ * Команды отправляются одной посылкой, после чего ожидается завершение действий
+ * и проверяется наличие ошибок на приборе. Пакет очищается, даже если возникло
+ * исключение.
+ */
+void CommandBatch::flush() {
+    if (commands.empty()) {
+        return;
+    }
+
+    std::string message = std::move(commands);
+    commands.clear();
+
+    device.send_wait_err(std::move(message));
+}
+
+/**
+ * \brief Проверка наличия накопленных команд
+ *
+ * \return Если в пакете нет команд - true. В противном случае - false.
+ */
+bool CommandBatch::empty() const {
+    return commands.empty();
+}
+
+/**
+ * \brief Конструктор, который увеличивает таймаут прибора до таймаута выбранного
+ * класса
+ *
+ * \param [in] device Прибор, для которого изменяется таймаут
+ * \param [in] timeout_class Класс таймаута TIMEOUT_*
+ * \param [in] expected_time Ожидаемая длительность операции в секундах
+ */
+TimeoutScope::TimeoutScope(VisaDevice &device, int timeout_class, double expected_time) :
+        device(device), previous_timeout(device.current_timeout) {
+    device.apply_timeout(std::max(previous_timeout, device.get_timeout(timeout_class, expected_time)));
+}
+
+/**
+ * \brief Деструктор, который восстанавливает прежний таймаут прибора
+ */
+TimeoutScope::~TimeoutScope() {
+    device.apply_timeout(previous_timeout);
+}
@@ -11,15 +11,35 @@
 
 #include <format>
 #include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
 
-#include "visa.h"
+#include "device_actor.hpp"
+#include "transport/transport.hpp"
 #include "../utils/logger.hpp"
 
-/// Размер буфера для данных, которые приходят от прибора
-#define BUFFER_SIZE             128
-
-/// Стандартный таймаут команды
-#define DEFAULT_TIMEOUT         1000000
+/// Начальный размер буфера для данных, которые приходят от прибора
+#define READ_BUFFER_MIN_SIZE    65536
+
+/// Символ, с которого начинается двоичный блок данных в формате IEEE 488.2
+#define BLOCK_HEADER_START      '#'
+/// Максимальное количество цифр в поле длины двоичного блока данных
+#define BLOCK_HEADER_MAX_DIGITS 9
+
+/// Разделитель команд в одной посылке
+#define BATCH_DELIMITER         ';'
+/// Максимальная длина посылки, в которую объединяются команды пакета
+#define BATCH_MAX_LENGTH        2048
+
+/// Стандартный таймаут команды (класс TIMEOUT_QUERY) в миллисекундах
+#define DEFAULT_TIMEOUT         5000
+/// Стандартный таймаут команд настройки (класс TIMEOUT_CONFIG) в миллисекундах
+#define DEFAULT_CONFIG_TIMEOUT  30000
+/// Стандартный запас таймаута измерения (класс TIMEOUT_SWEEP) в миллисекундах
+#define DEFAULT_SWEEP_TIMEOUT   5000
+/// Стандартный запас таймаута перемещения (класс TIMEOUT_MOTION) в миллисекундах
+#define DEFAULT_MOTION_TIMEOUT  10000
 /// Стандартный символ окончания посылки
 #define DEFAULT_VISA_TERM       '\n'
 
@@ -44,6 +64,54 @@
 #define CMD_OPC                 "*OPC?"
 /// Команда для запроса ошибок, возникших на приборе
 #define CMD_ERR                 "SYSTEM:ERROR?"
+/// Команда, по которой прибор устанавливает бит ESR_OPC_BIT после завершения действий
+#define CMD_OPC_SET             "*OPC"
+/// Команда для чтения (и очистки) регистра событий
+#define CMD_ESR                 "*ESR?"
+/// Команда для установки маски регистра событий
+#define CMD_ESE                 "*ESE {}"
+/// Команда для установки маски запроса обслуживания
+#define CMD_SRE                 "*SRE {}"
+
+/// Класс таймаута: запросы, на которые прибор отвечает сразу
+#define TIMEOUT_QUERY           0x00
+/// Класс таймаута: команды настройки, после которых ожидается завершение действий
+#define TIMEOUT_CONFIG          0x01
+/// Класс таймаута: ожидание завершения измерения
+#define TIMEOUT_SWEEP           0x02
+/// Класс таймаута: ожидание завершения перемещения оси ОПУ
+#define TIMEOUT_MOTION          0x03
+/// Количество классов таймаута
+#define TIMEOUT_CLASS_COUNT     4
+
+/// Во сколько раз таймаут измерения или перемещения превышает ожидаемую длительность операции
+#define TIMEOUT_EXPECTED_FACTOR 2
+/// Количество повторов запроса, на который прибор не ответил за время таймаута
+#define TIMEOUT_RETRY_COUNT     1
+
+/// Ожидание завершения действий: запрос "*OPC?"
+#define COMPLETION_OPC_QUERY    0x00
+/// Ожидание завершения действий: команда "*OPC" и опрос регистра событий запросом "*ESR?"
+#define COMPLETION_ESR_POLL     0x01
+/// Ожидание завершения действий: команда "*OPC" и запрос обслуживания (SRQ)
+#define COMPLETION_SRQ          0x02
+
+/// Бит регистра событий, который устанавливается после завершения действий (Operation Complete)
+#define ESR_OPC_BIT             0x01
+/// Биты регистра событий, которые устанавливаются при ошибках выполнения команд (QYE, DDE, EXE, CME)
+#define ESR_ERROR_BITS          0x3C
+/// Бит регистра состояния, который показывает наличие событий в регистре событий (Event Summary Bit)
+#define STB_ESB_BIT             0x20
+
+/// Максимальное количество ошибок, которые считываются из очереди прибора за одну проверку
+#define ERROR_QUEUE_MAX         32
+/// Максимальное количество сохраняемых посылок, после которых прибор сообщил об ошибке
+#define ERROR_SOURCES_MAX       16
+
+/// Начальный интервал между запросами состояния прибора в микросекундах
+#define POLL_INTERVAL_MIN_US    200
+/// Максимальный интервал между запросами состояния прибора в микросекундах
+#define POLL_INTERVAL_MAX_US    50000
 
 /// Стандартный ответ прибора, если на нём не возникло ошибок
 #define NO_ERROR_STR_KEYSIGHT   "+0,\"No error\""
@@ -67,32 +135,68 @@ struct visa_config {
 
     /// Таймаут выполнения команды. По-умолчанию таймаут = DEFAULT_TIMEOUT.
     int timeout = DEFAULT_TIMEOUT;
+    /// Таймаут команд настройки. По-умолчанию таймаут = DEFAULT_CONFIG_TIMEOUT.
+    int config_timeout = DEFAULT_CONFIG_TIMEOUT;
+    /// Запас таймаута измерения. По-умолчанию запас = DEFAULT_SWEEP_TIMEOUT.
+    int sweep_timeout = DEFAULT_SWEEP_TIMEOUT;
+    /// Запас таймаута перемещения. По-умолчанию запас = DEFAULT_MOTION_TIMEOUT.
+    int motion_timeout = DEFAULT_MOTION_TIMEOUT;
     /// Символ, которым оканчивается посылка. По-умолчанию символ = DEFAULT_VISA_TERM.
     char termination = DEFAULT_VISA_TERM;
+    /// Способ ожидания завершения действий. По-умолчанию COMPLETION_OPC_QUERY.
+    int completion = COMPLETION_OPC_QUERY;
+    /// Флаг отложенной проверки ошибок. По-умолчанию false.
+    bool deferred_errors = false;
 };
 
 /**
- * \brief Класс, в котором реализованы методы для управления устройством с помощью API VISA.
+ * \brief Класс, в котором реализованы методы для управления устройством с помощью
+ * команд SCPI.
+ *
+ * Передача данных выполняется через канал связи (см. Transport), который выбирается
+ * по адресу прибора при подключении: SCPI по TCP без библиотеки VISA для адресов
+ * вида "TCPIP0::<хост>::<порт>::SOCKET" или библиотека VISA для остальных адресов.
  */
 class VisaDevice {
     /// Конфигурация устройства для подключения
     visa_config device_config{};
 
-    /// Идентификатор менеджера ресурсов
-    ViSession resource_manager{};
-    /// Идентификатор устройства
-    ViSession device{};
-
-    /// Статус выполнения операции
-    ViStatus status{};
+    /// Канал связи с прибором
+    std::unique_ptr<Transport> transport{};
 
-    ViPUInt32 ret_count{};
+    /// Буфер для данных, которые приходят от прибора. Размер буфера увеличивается до
+    /// размера наибольшего ответа и сохраняется между вызовами read()
+    std::vector<char> read_buffer{};
 
     int write(std::string command);
     std::string read();
 
     std::string query(std::string command);
 
+    bool read_exact(char *buffer, size_t size);
+    std::vector<char> read_block();
+
+    /// Посылки, после которых прибор установил биты ошибок в регистре событий
+    /// (используется при отложенной проверке ошибок)
+    std::vector<std::string> error_sources{};
+
+    void wait_opc();
+    int wait_esr();
+    int wait_srq();
+
+    int send_wait_esr(std::string command);
+
+    /// Таймаут операций канала связи, который действует в данный момент (в миллисекундах)
+    int current_timeout = DEFAULT_TIMEOUT;
+
+    void apply_timeout(int timeout);
+
+    friend class TimeoutScope;
+
+    /// Поток ввода-вывода прибора. Создаётся при первом вызове submit() и
+    /// уничтожается раньше канала связи
+    std::unique_ptr<DeviceActor> actor{};
+
 protected:
     /// Переменная, которая показывает, подключен ли прибор или нет
     bool connected = false;
@@ -101,7 +205,7 @@ public:
     VisaDevice() = default;
     explicit VisaDevice(std::string device_address);
 
-    ~VisaDevice();
+    virtual ~VisaDevice();
 
     virtual void connect();
 
@@ -110,8 +214,20 @@ public:
 
     std::string idn();
     int opc();
+    int esr();
     int err();
 
+    bool set_completion_mode(int completion);
+    void set_deferred_errors(bool deferred_errors);
+    bool is_deferred_errors() const;
+
+    void check_errors();
+    void error_checkpoint();
+    int get_completion_mode() const;
+
+    bool set_timeout(int timeout_class, int timeout);
+    int get_timeout(int timeout_class, double expected_time = 0.0) const;
+
     void wait();
 
     std::string send(std::string command, bool read_data = false);
@@ -119,6 +235,42 @@ public:
     std::string send_err(std::string command);
     std::string send_wait_err(std::string command);
 
+    std::vector<char> send_block(std::string command);
+    std::vector<std::vector<char>> send_blocks(std::string command, size_t block_count);
+
+    /**
+     * \brief Выполнение действий с прибором в его потоке ввода-вывода
+     *
+     * Позволяет обмениваться данными с несколькими приборами одновременно. Пока
+     * результат не получен, методы прибора нельзя вызывать из других потоков
+     * напрямую: все обращения к прибору за это время должны передаваться через
+     * submit(), тогда они выполнятся по очереди.
+     *
+     * \param [in] function Функция, которая будет выполнена в потоке прибора
+     *
+     * \return Объект std::future, через который возвращается результат функции.
+     * Метод get() бросает antestl_exception, если его бросила функция.
+     *
+     * **Пример**
+     * \code
+     * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+     * GenDevice *gen = new KeysightGen("TCPIP0::localhost::5026::SOCKET");
+     *
+     * std::future<void> traces = vna->submit([vna]() { vna->create_traces({2, 4}, true); });
+     * gen->rf_on();
+     *
+     * traces.get();
+     * \endcode
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F &&function) {
+        if (actor == nullptr) {
+            actor = std::make_unique<DeviceActor>();
+        }
+
+        return actor->submit(std::forward<F>(function));
+    }
+
     /**
      * \brief Отправка данных на прибор и чтение ответа от прибора.
      *
@@ -272,6 +424,134 @@ public:
 
         return data;
     }
+
+    /**
+     * \brief Отправка запроса на прибор и чтение ответа в виде двоичного блока
+     * данных
+     *
+     * Данный метод позволяет сформировать команду, которая будет отправлена
+     * на прибор, с помощью строки форматирования и набора аргументов для неё.
+     *
+     * \param [in] fmt Строка форматирования
+     * \param [in] args Аргументы для строки форматирования
+     *
+     * \return Содержимое двоичного блока без заголовка
+     *
+     * **Пример**
+     * \code
+     * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+     * vna.connect();
+     *
+     * if (vna.is_connected()) {
+     *     vna.send(":FORMAT:DATA REAL,64");
+     *     std::vector<char> data = vna.send_block(":CALCULATE:MEASURE{}:DATA:SDATA?", 1);
+     * }
+     * \endcode
+     */
+    template <typename... T>
+    std::vector<char> send_block(const std::string &fmt, T &&...args) {
+        std::string command = std::vformat(fmt, std::make_format_args(args...));
+        std::vector<char> data{};
+
+        data = send_block(command);
+
+        return data;
+    }
+};
+
+/**
+ * \brief Класс пакета команд, которые отправляются на прибор одной посылкой
+ *
+ * Команды объединяются через символ BATCH_DELIMITER и отправляются методом
+ * VisaDevice::send_wait_err(), поэтому для всего пакета выполняются одна
+ * передача, одно ожидание завершения действий и одна проверка ошибок. Так как
+ * в составной посылке команда без двоеточия в начале отсчитывается от пути
+ * предыдущей команды, то к таким командам добавляется двоеточие.
+ *
+ * Если длина посылки превысила бы BATCH_MAX_LENGTH, то накопленные команды
+ * отправляются перед добавлением новой. Оставшиеся команды отправляются
+ * методом flush(). Запросы (команды, которые оканчиваются символом '?') в
+ * пакет не добавляются.
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * CommandBatch batch(vna);
+ *
+ * for (int port = 1; port < 9; ++port) {
+ *     batch.add(":SOURce:POWer{}:MODE OFF", port);
+ * }
+ *
+ * batch.flush();
+ * \endcode
+ */
+class CommandBatch {
+    /// Прибор, на который отправляются команды
+    VisaDevice &device;
+
+    /// Накопленные команды, объединённые через BATCH_DELIMITER
+    std::string commands{};
+
+public:
+    explicit CommandBatch(VisaDevice &device);
+
+    CommandBatch &add(std::string_view command);
+
+    /**
+     * \brief Добавление команды в пакет
+     *
+     * Команда формируется с помощью строки форматирования и набора аргументов для неё.
+     *
+     * \param [in] fmt Строка форматирования
+     * \param [in] args Аргументы для строки форматирования
+     *
+     * \return Ссылка на пакет
+     */
+    template <typename... T>
+    CommandBatch &add(const std::string &fmt, T &&...args) {
+        return add(std::string_view(std::vformat(fmt, std::make_format_args(args...))));
+    }
+
+    void flush();
+
+    bool empty() const;
+};
+
+/**
+ * \brief Класс области действия таймаута
+ *
+ * На время существования объекта таймаут канала связи прибора увеличивается до
+ * таймаута выбранного класса (см. VisaDevice::get_timeout()), а в деструкторе
+ * восстанавливается прежнее значение. Вложенная область не уменьшает таймаут,
+ * установленный внешней областью, поэтому команды настройки внутри ожидания
+ * измерения не прерываются раньше времени.
+ *
+ * **Пример**
+ * \code
+ * VisaDevice vna("TCPIP0::localhost::5025::SOCKET");
+ * vna.connect();
+ *
+ * {
+ *     TimeoutScope timeout_scope(vna, TIMEOUT_SWEEP, 2.5);
+ *     vna.send_wait("INIT:IMM");
+ * }
+ * \endcode
+ */
+class TimeoutScope {
+    /// Прибор, для которого изменяется таймаут
+    VisaDevice &device;
+
+    /// Таймаут, который действовал до создания объекта
+    int previous_timeout;
+
+public:
+    TimeoutScope(VisaDevice &device, int timeout_class, double expected_time = 0.0);
+    ~TimeoutScope();
+
+    TimeoutScope(const TimeoutScope &) = delete;
+    TimeoutScope &operator=(const TimeoutScope &) = delete;
 };
 
 typedef VisaDevice visa_device_t;
@@ -34,6 +34,7 @@ KeysightM9807A::KeysightM9807A(std::string device_address) : VnaDevice(std::move
  * \endcode
  */
 void KeysightM9807A::preset() {
+    active_traces = {};
     send(":SYSTEM:PRESET");
 }
 
@@ -47,6 +48,8 @@ void KeysightM9807A::preset() {
   * \endcode
   */
 void KeysightM9807A::full_preset() {
+    active_traces = {};
+
     send("*CLS");
     send("*RST");
 
@@ -54,7 +57,7 @@ void KeysightM9807A::full_preset() {
     send(":DISPLAY:WINDOW1:STATE 1");
     send(":CALCULATE:PARAMETER:DELETE:ALL");
 
-    send(":FORMAT:DATA ASCII,0");
+    set_data_format(data_format, swapped_bytes);
 }
 
 /**
@@ -69,15 +72,18 @@ void KeysightM9807A::full_preset() {
  * \endcode
  */
 void KeysightM9807A::init_channel() {
-    send_wait_err(R"(:CALCulate1:CUSTom:DEFine "TR0","Standard","S11")");
+    CommandBatch batch(*this);
+
+    batch.add(R"(:CALCulate1:CUSTom:DEFine "TR0","Standard","S11")");
 
-    send_wait_err(":SOURce:POWer:COUPle 1");
+    batch.add(":SOURce:POWer:COUPle 1");
 
     for (int port = 1; port < M9807A_PORT_COUNT + 1; ++port) {
-        send_wait_err(":SOURce:POWer{}:MODE OFF", port);
+        batch.add(":SOURce:POWer{}:MODE OFF", port);
     }
 
-    send_wait_err(":SOURce:POWer:COUPle 0");
+    batch.add(":SOURce:POWer:COUPle 0");
+    batch.flush();
 }
 
 /**
@@ -103,16 +109,25 @@ void KeysightM9807A::configure(int meas_type, float rbw, int source_port) {
     this->rbw = rbw;
     this->source_port = source_port;
 
-    send_wait_err(":SENSE:ROSC:SOUR PXIBackplane");
+    CommandBatch batch(*this);
 
-    send_wait_err(":SENSe:SWEep:MODE HOLD");
-    send_wait_err(":SENSe:BANDwidth:RESolution {}", this->rbw);
+    batch.add(":SENSE:ROSC:SOUR PXIBackplane");
+
+    batch.add(":SENSe:SWEep:MODE HOLD");
+    batch.add(":SENSe:BANDwidth:RESolution {}", this->rbw);
+    batch.flush();
 }
 
 /**
  * \brief Создание необходимых трасс, в зависимости от того, используется ли внешний
  * генератор
  *
+ * Трассы создаются заново, только если изменился список портов, тип измерения,
+ * зондирующий порт или флаг external. Пока трассы создаются, набор active_traces
+ * сброшен, поэтому после ошибки они будут созданы заново при следующем вызове.
+ * Набор запоминается только после контрольной точки проверки ошибок, так как
+ * при отложенной проверке batch.flush() не сообщает об ошибках.
+ *
  * \param [in] port_list Список портов, для которых неободимо создать трассы
  * \param [in] external Флаг, который показывает используется ли внешний генератор
  *
@@ -129,7 +144,17 @@ void KeysightM9807A::configure(int meas_type, float rbw, int source_port) {
  * \endcode
  */
 void KeysightM9807A::create_traces(std::vector<int> port_list, bool external) {
-    send_wait_err(":CALCulate:PARameter:DELete:ALL");
+    trace_set_t trace_set{port_list, meas_type, source_port, external};
+
+    if (trace_set == active_traces) {
+        logger::log(LEVEL_TRACE, "Traces are up to date");
+        return;
+    }
+
+    active_traces = {};
+
+    CommandBatch batch(*this);
+    batch.add(":CALCulate:PARameter:DELete:ALL");
 
     std::string trace_name{};
     std::string trace_params{};
@@ -166,9 +191,14 @@ void KeysightM9807A::create_traces(std::vector<int> port_list, bool external) {
             }
         }
 
-        send_wait_err(R"(:CALCulate1:CUSTom:DEFine "TR{}","Standard","{}")", port_list[pos], trace_params);
-        send_wait_err(":DISPlay:WINDow:TRACe{}:FEED \"TR{}\"", port_list[pos], port_list[pos]);
+        batch.add(R"(:CALCulate1:CUSTom:DEFine "TR{}","Standard","{}")", port_list[pos], trace_params);
+        batch.add(":DISPlay:WINDow:TRACe{}:FEED \"TR{}\"", port_list[pos], port_list[pos]);
     }
+
+    batch.flush();
+    error_checkpoint();
+
+    active_traces = std::move(trace_set);
 }
 
 /**
@@ -186,9 +216,13 @@ void KeysightM9807A::create_traces(std::vector<int> port_list, bool external) {
 void KeysightM9807A::set_power(float power) {
     this->power = power;
 
+    CommandBatch batch(*this);
+
     for (int port = 1; port < M9807A_PORT_COUNT + 1; ++port) {
-        send_wait_err(":SOURce:POWer{}:LEVel:IMMediate:AMPLitude {},\"Port {}\"", port, this->power, port);
+        batch.add(":SOURce:POWer{}:LEVel:IMMediate:AMPLitude {},\"Port {}\"", port, this->power, port);
     }
+
+    batch.flush();
 }
 
 /**
@@ -216,10 +250,13 @@ void KeysightM9807A::set_freq_range(double start_freq, double stop_freq, int poi
 
     freq_step = this->points <= 1 ? 0 : (this->stop_freq - this->start_freq) / (this->points - 1);
 
-    send_wait_err(":SENSe:SWEep:POINts {}", this->points);
+    CommandBatch batch(*this);
 
-    send_wait_err(":SENSe:FREQuency:STARt {}", this->start_freq);
-    send_wait_err(":SENSe:FREQuency:STOP {}", this->stop_freq);
+    batch.add(":SENSe:SWEep:POINts {}", this->points);
+
+    batch.add(":SENSe:FREQuency:STARt {}", this->start_freq);
+    batch.add(":SENSe:FREQuency:STOP {}", this->stop_freq);
+    batch.flush();
 }
 
 /**
@@ -245,10 +282,13 @@ void KeysightM9807A::set_freq(double freq) {
 
     freq_step = 0;
 
-    send_wait_err(":SENSe:SWEep:POINts {}", points);
+    CommandBatch batch(*this);
+
+    batch.add(":SENSe:SWEep:POINts {}", points);
 
-    send_wait_err(":SENSe:FREQuency:STARt {}", start_freq);
-    send_wait_err(":SENSe:FREQuency:STOP {}", stop_freq);
+    batch.add(":SENSe:FREQuency:STARt {}", start_freq);
+    batch.add(":SENSe:FREQuency:STOP {}", stop_freq);
+    batch.flush();
 }
 
 /**
@@ -263,16 +303,21 @@ void KeysightM9807A::set_freq(double freq) {
  * \endcode
  */
 void KeysightM9807A::set_path(std::vector<int> path_list) {
+    CommandBatch batch(*this);
+
     for (int mod = 0; mod < M9807A_MODULE_COUNT; ++mod) {
         if (path_list[mod] == this->path_list[mod] || path_list[mod] == -1) {
             continue;
         }
 
         this->path_list[mod] = path_list[mod];
-        send_wait_err("SENS:SWIT:M9157:MOD{}:SWIT:PATH STAT{}", mod + 1, this->path_list[mod]);
+        batch.add("SENS:SWIT:M9157:MOD{}:SWIT:PATH STAT{}", mod + 1, this->path_list[mod]);
     }
 
-    send_wait_err("INIT");
+    batch.add("INIT");
+
+    TimeoutScope timeout_scope(*this, TIMEOUT_SWEEP, get_sweep_time());
+    batch.flush();
 }
 
 /**
@@ -290,6 +335,15 @@ int KeysightM9807A::get_switch_module_count() {
     return M9807A_MODULE_COUNT;
 }
 
+/**
+ * \brief Запрос количества портов ВАЦ
+ *
+ * \return Количество портов
+ */
+int KeysightM9807A::get_port_count() {
+    return M9807A_PORT_COUNT;
+}
+
 /**
  * \brief Отключает все порты
  *
@@ -300,11 +354,14 @@ int KeysightM9807A::get_switch_module_count() {
  * \endcode
  */
 void KeysightM9807A::rf_off() {
-    send_wait_err(":SOURce:POWer:COUPle 0");
+    CommandBatch batch(*this);
+    batch.add(":SOURce:POWer:COUPle 0");
 
     for (int port = 1; port < M9807A_PORT_COUNT + 1; ++port) {
-        send_wait_err(":SOURce:POWer{}:MODE OFF", port);
+        batch.add(":SOURce:POWer{}:MODE OFF", port);
     }
+
+    batch.flush();
 }
 
 /**
@@ -319,8 +376,11 @@ void KeysightM9807A::rf_off() {
  * \endcode
  */
 void KeysightM9807A::rf_off(int port) {
-    send_wait_err(":SOURce:POWer:COUPle 0");
-    send_wait_err(":SOURce:POWer{}:MODE OFF", port);
+    CommandBatch batch(*this);
+
+    batch.add(":SOURce:POWer:COUPle 0");
+    batch.add(":SOURce:POWer{}:MODE OFF", port);
+    batch.flush();
 }
 
 /**
@@ -333,11 +393,14 @@ void KeysightM9807A::rf_off(int port) {
  * \endcode
  */
 void KeysightM9807A::rf_on() {
-    send_wait_err(":SOURce:POWer:COUPle 0");
+    CommandBatch batch(*this);
+    batch.add(":SOURce:POWer:COUPle 0");
 
     for (int port = 1; port < M9807A_PORT_COUNT + 1; ++port) {
-        send_wait_err(":SOURce:POWer{}:MODE ON", port);
+        batch.add(":SOURce:POWer{}:MODE ON", port);
     }
+
+    batch.flush();
 }
 
 /**
@@ -352,8 +415,67 @@ void KeysightM9807A::rf_on() {
  * \endcode
  */
 void KeysightM9807A::rf_on(int port) {
-    send_wait_err(":SOURce:POWer:COUPle 0");
-    send_wait_err(":SOURce:POWer{}:MODE ON", port);
+    CommandBatch batch(*this);
+
+    batch.add(":SOURce:POWer:COUPle 0");
+    batch.add(":SOURce:POWer{}:MODE ON", port);
+    batch.flush();
+}
+
+/**
+ * \brief Отключает порты из списка
+ *
+ * \param [in] port_list Список портов, которые будут отключены
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+ * vna->rf_off({1, 2, 3});
+ * \endcode
+ */
+void KeysightM9807A::rf_off(const std::vector<int> &port_list) {
+    CommandBatch batch(*this);
+    batch.add(":SOURce:POWer:COUPle 0");
+
+    for (int port : port_list) {
+        batch.add(":SOURce:POWer{}:MODE OFF", port);
+    }
+
+    batch.flush();
+}
+
+/**
+ * \brief Включает порты из списка для измерения коэффициента отражения
+ *
+ * Порты переводятся в режим AUTO, в котором мощность подаётся на порт только во
+ * время прохода, где он является зондирующим. Поэтому за один запуск измерения
+ * ВАЦ по очереди измеряет все трассы S<порт><порт>, а команды на включение и
+ * отключение передаются одной посылкой.
+ *
+ * \param [in] port_list Список портов, которые будут включены
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+ *
+ * vna->configure(MEAS_REFLECTION, 1e3, 1);
+ * vna->create_traces({1, 2, 3}, false);
+ *
+ * vna->rf_on({1, 2, 3});
+ *
+ * vna->trigger();
+ * vna->init();
+ * \endcode
+ */
+void KeysightM9807A::rf_on(const std::vector<int> &port_list) {
+    CommandBatch batch(*this);
+    batch.add(":SOURce:POWer:COUPle 0");
+
+    for (int port : port_list) {
+        batch.add(":SOURce:POWer{}:MODE AUTO", port);
+    }
+
+    batch.flush();
 }
 
 /**
@@ -366,10 +488,13 @@ void KeysightM9807A::rf_on(int port) {
  * \endcode
  */
 void KeysightM9807A::trigger() {
-    send_wait_err(":TRIGger:SEQuence:SOURce MANual");
-    send_wait_err(":TRIGger:SEQuence:SCOPe CURRent");
+    CommandBatch batch(*this);
 
-    send_wait_err("TRIG:SCOP ALL");
+    batch.add(":TRIGger:SEQuence:SOURce MANual");
+    batch.add(":TRIGger:SEQuence:SCOPe CURRent");
+
+    batch.add("TRIG:SCOP ALL");
+    batch.flush();
 }
 
 /**
@@ -384,15 +509,90 @@ void KeysightM9807A::trigger() {
  * \endcode
  */
 void KeysightM9807A::init() {
+    TimeoutScope timeout_scope(*this, TIMEOUT_SWEEP, get_sweep_time());
     send_wait_err("INIT:IMM");
 }
 
+/**
+ * \brief Включение или отключение выходного триггера, который формируется
+ * по завершении каждого измерения
+ *
+ * Выходной триггер используется для перехода внешнего генератора к следующей
+ * точке списка частот.
+ *
+ * \param [in] enabled Флаг, показывающий, требуется ли формировать выходной триггер
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+ * vna->set_trigger_output(true);
+ * \endcode
+ */
+void KeysightM9807A::set_trigger_output(bool enabled) {
+    CommandBatch batch(*this);
+
+    if (enabled) {
+        batch.add(":TRIGger:CHANnel1:AUXiliary1:INTerval SWEep");
+        batch.add(":TRIGger:CHANnel1:AUXiliary1:POSition AFTer");
+        batch.add(":TRIGger:CHANnel1:AUXiliary1:OPOLarity POSitive");
+    }
+
+    batch.add(":TRIGger:CHANnel1:AUXiliary1 {}", enabled ? "ON" : "OFF");
+    batch.flush();
+}
+
+/**
+ * \brief Метод позволяет узнать, может ли ВАЦ формировать выходной триггер
+ *
+ * \return Всегда возвращает true, так как выходной триггер формируется
+ * через разъём AUX TRIG 1
+ */
+bool KeysightM9807A::has_trigger_output() {
+    return true;
+}
+
+/**
+ * \brief Установка формата, в котором ВАЦ передаёт данные трасс
+ *
+ * В двоичных форматах трасса передаётся блоком "#<n><длина><данные>", что
+ * уменьшает объём передаваемых данных и избавляет от разбора текста.
+ *
+ * \param [in] data_format Формат данных (DATA_FORMAT_ASCII, DATA_FORMAT_REAL32
+ * или DATA_FORMAT_REAL64)
+ * \param [in] swapped_bytes Флаг, показывающий, требуется ли передавать двоичные
+ * данные младшим байтом вперёд
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+ * vna->set_data_format(DATA_FORMAT_REAL64, true);
+ * \endcode
+ */
+void KeysightM9807A::set_data_format(int data_format, bool swapped_bytes) {
+    switch (data_format) {
+        case DATA_FORMAT_REAL32:
+            send(":FORMAT:DATA REAL,32");
+            break;
+        case DATA_FORMAT_REAL64:
+            send(":FORMAT:DATA REAL,64");
+            break;
+        default:
+            data_format = DATA_FORMAT_ASCII;
+            send(":FORMAT:DATA ASCII,0");
+            break;
+    }
+
+    send(":FORMAT:BORDER {}", swapped_bytes ? "SWAPPED" : "NORMAL");
+
+    this->data_format = data_format;
+    this->swapped_bytes = swapped_bytes;
+}
+
 /**
  * \brief Сбор данных, полученных в результате измерения, для одного порта
  *
  * \param [in] trace_index Индекс трассы, которая соответствует требуемому порту
- *
- * \return Результат измерений одного порта
+ * \param [out] iq_data Результат измерений одного порта
  *
  * **Пример**
  * \code
@@ -409,18 +609,56 @@ void KeysightM9807A::init() {
  * vna->trigger();
  * vna->init();
  *
- * iq_port_data_t port_data = vna->get_data(0);     // Получает данные для 2 порта
+ * iq_port_data_t port_data{};
+ * vna->get_data(0, port_data);     // Получает данные для 2 порта
  * \endcode
  */
-iq_port_data_t KeysightM9807A::get_data(int trace_index) {
-    iq_port_data_t iq_data{};
+void KeysightM9807A::get_data(int trace_index, iq_port_data_t &iq_data) {
+    if (data_format != DATA_FORMAT_ASCII) {
+        parse_iq_block(send_block(":CALCULATE:MEASURE{}:DATA:SDATA?", trace_index + 1), iq_data);
+        return;
+    }
 
     std::string received_data = send(":CALCULATE:MEASURE{}:DATA:SDATA?", trace_index + 1);
-    std::vector<std::string> cached_data = string_utils::split(received_data, DATA_DELIMITER);
+    parse_iq_data(received_data, iq_data);
+}
+
+/**
+ * \brief Сбор данных, полученных в результате измерения, для нескольких трасс
+ *
+ * Запросы данных всех трасс объединяются в один составной запрос, поэтому
+ * данные передаются за одну транзакцию, а ответ разделяется на трассы локально.
+ *
+ * \param [in] trace_count Количество трасс
+ * \param [out] iq_data_list Результаты измерений для каждой трассы
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new KeysightM9807A("TCPIP0::localhost::5025::SOCKET");
+ *
+ * vna->create_traces({2, 4, 5}, false);
+ *
+ * vna->trigger();
+ * vna->init();
+ *
+ * std::vector<iq_port_data_t> data{};
+ * vna->get_data_list(3, data);     // Получает данные для 2, 4 и 5 портов
+ * \endcode
+ */
+void KeysightM9807A::get_data_list(int trace_count, std::vector<iq_port_data_t> &iq_data_list) {
+    const std::string &command = get_data_list_query(":CALCULATE:MEASURE{}:DATA:SDATA?", trace_count);
+
+    if (data_format != DATA_FORMAT_ASCII) {
+        std::vector<std::vector<char>> block_list = send_blocks(command, trace_count);
+        iq_data_list.resize(block_list.size());
+
+        for (size_t trace_index = 0; trace_index < block_list.size(); ++trace_index) {
+            parse_iq_block(block_list[trace_index], iq_data_list[trace_index]);
+        }
 
-    for (int pos = 0; pos < cached_data.size(); pos += 2) {
-        iq_data.emplace_back(cached_data[pos], cached_data[pos + 1]);
+        return;
     }
 
-    return iq_data;
+    std::string received_data = send(command);
+    parse_iq_data_list(received_data, trace_count, iq_data_list);
 }
\ No newline at end of file
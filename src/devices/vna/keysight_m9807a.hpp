@@ -46,18 +46,26 @@ public:
 
     void set_path(std::vector<int> path_list) override;
     int get_switch_module_count() override;
+    int get_port_count() override;
 
     void rf_off() override;
     void rf_off(int port) override;
+    void rf_off(const std::vector<int> &port_list) override;
 
     void rf_on() override;
     void rf_on(int port) override;
+    void rf_on(const std::vector<int> &port_list) override;
 
     void trigger() override;
 
     void init() override;
 
-    iq_port_data_t get_data(int trace_index) override;
+    void set_trigger_output(bool enabled) override;
+    bool has_trigger_output() override;
+    void set_data_format(int data_format, bool swapped_bytes) override;
+
+    void get_data(int trace_index, iq_port_data_t &iq_data) override;
+    void get_data_list(int trace_count, std::vector<iq_port_data_t> &iq_data_list) override;
 };
 
 
@@ -6,6 +6,7 @@
  * \date 19 сентября 2023
  */
 
+#include <charconv>
 #include <thread>
 #include "planar_s50244.h"
 #include "../../utils/string_utils.hpp"
@@ -35,6 +36,9 @@ PlanarS50244::PlanarS50244(std::string device_address) : VnaDevice(std::move(dev
  * \endcode
  */
 void PlanarS50244::preset() {
+    active_traces = {};
+    sweep_time = -1.0;
+
     send(":SYSTEM:PRESET");
 }
 
@@ -48,11 +52,14 @@ void PlanarS50244::preset() {
   * \endcode
   */
 void PlanarS50244::full_preset() {
+    active_traces = {};
+    sweep_time = -1.0;
+
     send("*CLS");
     send("*RST");
 
     send(":SYSTEM:PRESET");
-    send(":FORMAT:DATA ASCII");
+    set_data_format(data_format, swapped_bytes);
 }
 
 /**
@@ -67,17 +74,19 @@ void PlanarS50244::full_preset() {
  * \endcode
  */
 void PlanarS50244::init_channel() {
+    CommandBatch batch(*this);
 
-    send_wait_err(":SOURce:POWer:PORT:COUPle 0");
-    send_wait_err(":OUTPUT:STATE OFF");
+    batch.add(":SOURce:POWer:PORT:COUPle 0");
+    batch.add(":OUTPUT:STATE OFF");
 
-    send_wait_err("TRIG:SEQ:SOUR MAN");
-    //send_wait_err("SENS:SWE:MODE CONT");
+    batch.add("TRIG:SEQ:SOUR MAN");
+    //batch.add("SENS:SWE:MODE CONT");
 
-    send_wait_err(":DISPlay:SPLIT 1");
-    send_wait_err(":DISPlay:WINDOW1:ACTIVATE");
+    batch.add(":DISPlay:SPLIT 1");
+    batch.add(":DISPlay:WINDOW1:ACTIVATE");
 
-    send_wait_err("INITiate:CONTinuous OFF");
+    batch.add("INITiate:CONTinuous OFF");
+    batch.flush();
 }
 
 /**
@@ -103,16 +112,27 @@ void PlanarS50244::configure(int meas_type, float rbw, int source_port) {
     this->rbw = rbw;
     this->source_port = source_port;
 
-    send_wait_err(":TRIGger:SEQuence:SCOPe ACTive");
-    send_wait_err("TRIG:SCOP ALL");
+    sweep_time = -1.0;
+
+    CommandBatch batch(*this);
 
-    send_wait_err(":SENSe:BANDwidth:RESolution {}", this->rbw);
+    batch.add(":TRIGger:SEQuence:SCOPe ACTive");
+    batch.add("TRIG:SCOP ALL");
+
+    batch.add(":SENSe:BANDwidth:RESolution {}", this->rbw);
+    batch.flush();
 }
 
 /**
  * \brief Создание необходимых трасс, в зависимости от того, используется ли внешний
  * генератор
  *
+ * Трассы создаются заново, только если изменился список портов, тип измерения,
+ * зондирующий порт или флаг external. Пока трассы создаются, набор active_traces
+ * сброшен, поэтому после ошибки они будут созданы заново при следующем вызове.
+ * Набор запоминается только после контрольной точки проверки ошибок, так как
+ * при отложенной проверке batch.flush() не сообщает об ошибках.
+ *
  * \param [in] port_list Список портов, для которых неободимо создать трассы
  * \param [in] external Флаг, который показывает используется ли внешний генератор
  *
@@ -129,6 +149,17 @@ void PlanarS50244::configure(int meas_type, float rbw, int source_port) {
  * \endcode
  */
 void PlanarS50244::create_traces(std::vector<int> port_list, bool external) {
+    trace_set_t trace_set{port_list, meas_type, source_port, external};
+
+    if (trace_set == active_traces) {
+        logger::log(LEVEL_TRACE, "Traces are up to date");
+        return;
+    }
+
+    active_traces = {};
+
+    CommandBatch batch(*this);
+
     std::string trace_name{};
     std::string trace_params{};
 
@@ -139,9 +170,14 @@ void PlanarS50244::create_traces(std::vector<int> port_list, bool external) {
             trace_name = std::format("S{}{}", port_list[pos], port_list[pos]);
         }
 
-        send_wait_err(R"(:CALCulate1:PARameter:DEFine {})", trace_name);
-        send_wait_err(":DISPlay:WINDow:TRACe1:STATe ON");
+        batch.add(R"(:CALCulate1:PARameter:DEFine {})", trace_name);
+        batch.add(":DISPlay:WINDow:TRACe1:STATe ON");
     }
+
+    batch.flush();
+    error_checkpoint();
+
+    active_traces = std::move(trace_set);
 }
 
 /**
@@ -159,9 +195,13 @@ void PlanarS50244::create_traces(std::vector<int> port_list, bool external) {
 void PlanarS50244::set_power(float power) {
     this->power = power;
 
+    CommandBatch batch(*this);
+
     for (int port = 1; port < S50244_PORT_COUNT + 1; ++port) {
-        send_wait_err(":SOURce:POWer:PORT{}:LEVel:IMMediate:AMPLitude {}", port, this->power);
+        batch.add(":SOURce:POWer:PORT{}:LEVel:IMMediate:AMPLitude {}", port, this->power);
     }
+
+    batch.flush();
 }
 
 /**
@@ -188,11 +228,15 @@ void PlanarS50244::set_freq_range(double start_freq, double stop_freq, int point
     this->points = points;
 
     freq_step = this->points <= 1 ? 0 : (this->stop_freq - this->start_freq) / (this->points - 1);
+    sweep_time = -1.0;
+
+    CommandBatch batch(*this);
 
-    send_wait_err(":SENSe:SWEep:POINts {}", this->points);
+    batch.add(":SENSe:SWEep:POINts {}", this->points);
 
-    send_wait_err(":SENSe:FREQuency:STARt {}", this->start_freq);
-    send_wait_err(":SENSe:FREQuency:STOP {}", this->stop_freq);
+    batch.add(":SENSe:FREQuency:STARt {}", this->start_freq);
+    batch.add(":SENSe:FREQuency:STOP {}", this->stop_freq);
+    batch.flush();
 }
 
 /**
@@ -217,11 +261,15 @@ void PlanarS50244::set_freq(double freq) {
     points = 1;
 
     freq_step = 0;
+    sweep_time = -1.0;
 
-    send_wait_err(":SENSe:SWEep:POINts {}", points);
+    CommandBatch batch(*this);
 
-    send_wait_err(":SENSe:FREQuency:STARt {}", start_freq);
-    send_wait_err(":SENSe:FREQuency:STOP {}", stop_freq);
+    batch.add(":SENSe:SWEep:POINts {}", points);
+
+    batch.add(":SENSe:FREQuency:STARt {}", start_freq);
+    batch.add(":SENSe:FREQuency:STOP {}", stop_freq);
+    batch.flush();
 }
 
 /**
@@ -249,8 +297,11 @@ void PlanarS50244::rf_off() {
  * \endcode
  */
 void PlanarS50244::rf_off(int port) {
-    send_wait_err(":OUTPUT:STATE OFF");
-    send_wait_err(":CALC:PAR:SPOR {}", port);
+    CommandBatch batch(*this);
+
+    batch.add(":OUTPUT:STATE OFF");
+    batch.add(":CALC:PAR:SPOR {}", port);
+    batch.flush();
 }
 
 /**
@@ -278,12 +329,67 @@ void PlanarS50244::rf_on() {
  * \endcode
  */
 void PlanarS50244::rf_on(int port) {
-    send_wait_err(":CALC:PAR:SPOR {}", port);
-    send_wait_err(":OUTPUT:STATE ON");
+    CommandBatch batch(*this);
+
+    batch.add(":CALC:PAR:SPOR {}", port);
+    batch.add(":OUTPUT:STATE ON");
+    batch.flush();
+}
+
+/**
+ * \brief Отключает порты из списка
+ *
+ * Выход ВАЦ отключается для всех портов сразу.
+ *
+ * \param [in] port_list Список портов, которые будут отключены
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new PlanarS50244("TCPIP0::localhost::5025::SOCKET");
+ * vna->rf_off({1, 2});
+ * \endcode
+ */
+void PlanarS50244::rf_off(const std::vector<int> &port_list) {
+    rf_off();
 }
 
 /**
- * \brief Перевод триггера в режим manual
+ * \brief Включает порты из списка для измерения коэффициента отражения
+ *
+ * При включённом выходе ВАЦ за один запуск измерения сам выполняет проходы для
+ * зондирующих портов всех созданных трасс, поэтому зондирующий порт отдельно
+ * не выбирается.
+ *
+ * \param [in] port_list Список портов, которые будут включены
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new PlanarS50244("TCPIP0::localhost::5025::SOCKET");
+ *
+ * vna->configure(MEAS_REFLECTION, 1e3, 1);
+ * vna->create_traces({1, 2}, false);
+ *
+ * vna->rf_on({1, 2});
+ * vna->trigger();
+ * \endcode
+ */
+void PlanarS50244::rf_on(const std::vector<int> &port_list) {
+    rf_on();
+}
+
+/**
+ * \brief Запуск измерения и ожидание его завершения
+ *
+ * Вместо непрерывного опроса состояния триггера метод ожидает время, за которое
+ * ВАЦ должен выполнить измерение (см. get_sweep_time()), после чего проверяет
+ * состояние триггера запросом ":TRIGger:STATus?". Если измерение ещё не
+ * завершено, то запрос повторяется с интервалом, который удваивается от
+ * POLL_INTERVAL_MIN_US до POLL_INTERVAL_MAX_US. Общее время ожидания ограничено
+ * таймаутом класса TIMEOUT_SWEEP.
+ *
+ * Ожидание прерывается запросом abort_signal (см. set_abort_signal()): измерение
+ * останавливается командой ":ABORt" и бросается исключение antestl_exception с
+ * кодом ABORTED_CODE.
  *
  * **Пример**
  * \code
@@ -292,22 +398,62 @@ void PlanarS50244::rf_on(int port) {
  * \endcode
  */
 void PlanarS50244::trigger() {
-    while (true) {
-        std::string answer = send(":TRIGGER:STATUS?");
+    if (sweep_time < 0) {
+        std::string answer = send(":SENSe:SWEep:TIME?");
+        size_t begin = answer.starts_with('+') ? 1 : 0;
+
+        sweep_time = 0.0;
+        std::from_chars(answer.data() + begin, answer.data() + answer.size(), sweep_time);
+
+        logger::log(LEVEL_DEBUG, "Planar S50244 sweep time = {} s", sweep_time);
+    }
+
+    send("INIT");
+    send("TRIG:SING");
+
+    double expected_time = get_sweep_time();
+    auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(get_timeout(TIMEOUT_SWEEP, expected_time));
+
+    bool waited = wait_unless_aborted(std::chrono::microseconds((long long) (expected_time * 1e6)));
+    int interval = POLL_INTERVAL_MIN_US;
 
-        if (answer == "HOLD") {
-            send("INIT");
-            send("TRIG:SING");
+    while (waited) {
+        if (send(":TRIGger:STATus?") == S50244_TRIGGER_HOLD) {
+            return;
+        }
 
-            do {
-                answer = send(":TRIGGER:STATUS?");
-            } while (answer != "HOLD");
+        if (std::chrono::steady_clock::now() > deadline) {
+            logger::log(LEVEL_ERROR, TIMEOUT_MSG);
+            throw antestl_exception(TIMEOUT_MSG, TIMEOUT_CODE);
         }
 
-        break;
+        waited = wait_unless_aborted(std::chrono::microseconds(interval));
+        interval = std::min(interval * 2, POLL_INTERVAL_MAX_US);
     }
 
+    abort_signal->reset();
+    send(":ABORt");
+
+    logger::log(LEVEL_WARN, ABORTED_MSG);
+    throw antestl_exception(ABORTED_MSG, ABORTED_CODE);
+}
+
+/**
+ * \brief Оценка длительности одного измерения
+ *
+ * Если длительность прохода уже получена от ВАЦ запросом ":SENSe:SWEep:TIME?",
+ * то она умножается на количество проходов (см. get_sweep_count()). В противном
+ * случае используется оценка VnaDevice::get_sweep_time().
+ *
+ * \return Ориентировочная длительность измерения в секундах
+ */
+double PlanarS50244::get_sweep_time() const {
+    if (sweep_time < 0) {
+        return VnaDevice::get_sweep_time();
+    }
 
+    return (double) get_sweep_count() * sweep_time;
 }
 
 /**
@@ -325,12 +471,60 @@ void PlanarS50244::init() {
     logger::log(LEVEL_WARN, "'init' not implemented for Planar S50244");
 }
 
+/**
+ * \brief Включение или отключение выходного триггера, который формируется
+ * по завершении каждого измерения
+ *
+ * Выходной триггер не поддерживается (см. has_trigger_output()), поэтому
+ * предупреждение выводится только при попытке его включить.
+ *
+ * \param [in] enabled Флаг, показывающий, требуется ли формировать выходной триггер
+ */
+void PlanarS50244::set_trigger_output(bool enabled) {
+    if (enabled) {
+        logger::log(LEVEL_WARN, "'set_trigger_output' not implemented for Planar S50244");
+    }
+}
+
+/**
+ * \brief Установка формата, в котором ВАЦ передаёт данные трасс
+ *
+ * \param [in] data_format Формат данных (DATA_FORMAT_ASCII, DATA_FORMAT_REAL32
+ * или DATA_FORMAT_REAL64)
+ * \param [in] swapped_bytes Флаг, показывающий, требуется ли передавать двоичные
+ * данные младшим байтом вперёд
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new PlanarS50244("TCPIP0::localhost::5025::SOCKET");
+ * vna->set_data_format(DATA_FORMAT_REAL32, true);
+ * \endcode
+ */
+void PlanarS50244::set_data_format(int data_format, bool swapped_bytes) {
+    switch (data_format) {
+        case DATA_FORMAT_REAL32:
+            send(":FORMAT:DATA REAL32");
+            break;
+        case DATA_FORMAT_REAL64:
+            send(":FORMAT:DATA REAL");
+            break;
+        default:
+            data_format = DATA_FORMAT_ASCII;
+            send(":FORMAT:DATA ASCII");
+            break;
+    }
+
+    send(":FORMAT:BORDER {}", swapped_bytes ? "SWAPPED" : "NORMAL");
+
+    this->data_format = data_format;
+    this->swapped_bytes = swapped_bytes;
+}
+
 /**
  * \brief Сбор данных, полученных в результате измерения, для одного порта
  *
  * \param [in] trace_index Индекс трассы, которая соответствует требуемому порту
- *
- * \return Результат измерений одного порта
+ * \param [out] iq_data Результат измерений одного порта
  *
  * **Пример**
  * \code
@@ -347,26 +541,69 @@ void PlanarS50244::init() {
  * vna->trigger();
  * vna->init();
  *
- * iq_port_data_t port_data = vna->get_data(0);     // Получает данные для 2 порта
+ * iq_port_data_t port_data{};
+ * vna->get_data(0, port_data);     // Получает данные для 2 порта
  * \endcode
  */
-iq_port_data_t PlanarS50244::get_data(int trace_index) {
-    iq_port_data_t iq_data{};
+void PlanarS50244::get_data(int trace_index, iq_port_data_t &iq_data) {
+    if (data_format != DATA_FORMAT_ASCII) {
+        parse_iq_block(send_block(":CALCULATE:TRACE{}:DATA:SDATA?", trace_index + 1), iq_data, points == 1 ? 1 : 0);
+        return;
+    }
 
     std::string received_data = send(":CALCULATE:TRACE{}:DATA:SDATA?", trace_index + 1);
-    std::vector<std::string> cached_data = string_utils::split(received_data, DATA_DELIMITER);
+    parse_iq_data(received_data, iq_data, points == 1 ? 1 : 0);
+}
 
-    for (int pos = 0; pos < cached_data.size(); pos += 2) {
-        iq_data.emplace_back(cached_data[pos], cached_data[pos + 1]);
+/**
+ * \brief Сбор данных, полученных в результате измерения, для нескольких трасс
+ *
+ * Запросы данных всех трасс объединяются в один составной запрос, поэтому
+ * данные передаются за одну транзакцию, а ответ разделяется на трассы локально.
+ *
+ * \param [in] trace_count Количество трасс
+ * \param [out] iq_data_list Результаты измерений для каждой трассы
+ *
+ * **Пример**
+ * \code
+ * VnaDevice *vna = new PlanarS50244("TCPIP0::localhost::5025::SOCKET");
+ *
+ * vna->create_traces({2, 4, 5}, false);
+ *
+ * vna->trigger();
+ * vna->init();
+ *
+ * std::vector<iq_port_data_t> data{};
+ * vna->get_data_list(3, data);     // Получает данные для 2, 4 и 5 портов
+ * \endcode
+ */
+void PlanarS50244::get_data_list(int trace_count, std::vector<iq_port_data_t> &iq_data_list) {
+    const std::string &command = get_data_list_query(":CALCULATE:TRACE{}:DATA:SDATA?", trace_count);
+
+    if (data_format != DATA_FORMAT_ASCII) {
+        std::vector<std::vector<char>> block_list = send_blocks(command, trace_count);
+        iq_data_list.resize(block_list.size());
 
-        if (points == 1) {
-            return iq_data;
+        for (size_t trace_index = 0; trace_index < block_list.size(); ++trace_index) {
+            parse_iq_block(block_list[trace_index], iq_data_list[trace_index], points == 1 ? 1 : 0);
         }
+
+        return;
     }
 
-    return iq_data;
+    std::string received_data = send(command);
+    parse_iq_data_list(received_data, trace_count, iq_data_list, points == 1 ? 1 : 0);
 }
 
 void PlanarS50244::set_path(std::vector<int> path_list) {
     logger::log(LEVEL_WARN, "'set_path' not implemented for Planar S50244");
 }
+
+/**
+ * \brief Запрос количества портов ВАЦ
+ *
+ * \return Количество портов
+ */
+int PlanarS50244::get_port_count() {
+    return S50244_PORT_COUNT;
+}
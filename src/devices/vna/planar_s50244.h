@@ -13,6 +13,8 @@
 
 /// Количество портов у ВАЦ Planar S50244
 #define S50244_PORT_COUNT   2
+/// Состояние триггера Planar S50244 после завершения измерения
+#define S50244_TRIGGER_HOLD "HOLD"
 
 /**
  * \brief Класс, в котором реализованы методы для работы с ВАЦ Planar S50244
@@ -23,6 +25,10 @@ class PlanarS50244 : public VnaDevice {
     /// Массив номеров портов
     int port_numbers[S50244_PORT_COUNT] = {2, 1};
 
+    /// Длительность одного прохода в секундах, полученная запросом ":SENSe:SWEep:TIME?".
+    /// Отрицательное значение, если длительность требуется запросить заново
+    double sweep_time = -1.0;
+
 public:
     PlanarS50244() = default;
     explicit PlanarS50244(std::string device_address);
@@ -41,18 +47,26 @@ public:
     void set_freq(double freq) override;
 
     void set_path(std::vector<int> path_list) override;
+    int get_port_count() override;
 
     void rf_off() override;
     void rf_off(int port) override;
+    void rf_off(const std::vector<int> &port_list) override;
 
     void rf_on() override;
     void rf_on(int port) override;
+    void rf_on(const std::vector<int> &port_list) override;
 
     void trigger() override;
+    double get_sweep_time() const override;
 
     void init() override;
 
-    iq_port_data_t get_data(int trace_index) override;
+    void set_trigger_output(bool enabled) override;
+    void set_data_format(int data_format, bool swapped_bytes) override;
+
+    void get_data(int trace_index, iq_port_data_t &iq_data) override;
+    void get_data_list(int trace_count, std::vector<iq_port_data_t> &iq_data_list) override;
 };
 
 
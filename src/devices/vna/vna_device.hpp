@@ -11,7 +11,16 @@
 
 #include "../visa_device.hpp"
 #include "../../utils/exceptions.hpp"
-
+#include "../../utils/number_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <vector>
 
 /// Стандартная начальная частота для ВАЦ
@@ -38,14 +47,149 @@
 
 /// Разделитель данных, принимаемых от ВАЦ
 #define DATA_DELIMITER              ','
+/// Разделитель ответов на составной запрос
+#define RESPONSE_DELIMITER          ';'
+
+/// Формат данных трасс: текст
+#define DATA_FORMAT_ASCII           0x00
+/// Формат данных трасс: двоичный блок 32-битных чисел с плавающей точкой
+#define DATA_FORMAT_REAL32          0x01
+/// Формат данных трасс: двоичный блок 64-битных чисел с плавающей точкой
+#define DATA_FORMAT_REAL64          0x02
+
+/**
+ * \brief Структура, содержащая в себе значения квадратур для всех точек трассы
+ * одного порта
+ *
+ * Квадратуры хранятся в двух непрерывных массивах, поэтому данные преобразуются
+ * из строки в числа один раз, при получении от ВАЦ.
+ */
+struct iq_port_data_t {
+    /// Синфазные составляющие
+    std::vector<double> i{};
+    /// Квадратурные составляющие
+    std::vector<double> q{};
+
+    /**
+     * \brief Добавляет точку в конец трассы
+     *
+     * \param [in] i_value Синфазная составляющая
+     * \param [in] q_value Квадратурная составляющая
+     */
+    void push_back(double i_value, double q_value) {
+        i.push_back(i_value);
+        q.push_back(q_value);
+    }
+
+    /**
+     * \brief Резервирует память под требуемое количество точек
+     *
+     * \param [in] points Количество точек
+     */
+    void reserve(size_t points) {
+        i.reserve(points);
+        q.reserve(points);
+    }
+
+    /**
+     * \brief Запрос количества точек трассы
+     *
+     * \return Количество точек
+     */
+    size_t size() const {
+        return i.size();
+    }
+
+    /**
+     * \brief Проверка наличия данных
+     *
+     * \return Если трасса не содержит точек - true. В противном случае - false.
+     */
+    bool empty() const {
+        return i.empty();
+    }
 
-/// Структура, содержащая в себе значения квадратур в определённой точке
-struct iq {
-    std::string i{};
-    std::string q{};
+    /**
+     * \brief Удаляет все точки трассы
+     *
+     * Выделенная под массивы память сохраняется, поэтому при повторном заполнении
+     * трассы того же размера память заново не выделяется.
+     */
+    void clear() {
+        i.clear();
+        q.clear();
+    }
 };
 
-typedef std::vector<iq> iq_port_data_t;
+/**
+ * \brief Структура, описывающая набор трасс, созданных на ВАЦ
+ *
+ * Трассы создаются заново, только если набор изменился (см.
+ * VnaDevice::create_traces()).
+ */
+struct trace_set_t {
+    /// Список портов, для которых созданы трассы
+    std::vector<int> port_list{};
+    /// Тип измерения. Если трассы не созданы, то -1
+    int meas_type = -1;
+    /// Номер зондирующего порта
+    int source_port = 0;
+    /// Флаг, показывающий, используется ли внешний генератор
+    bool external = false;
+
+    bool operator==(const trace_set_t &) const = default;
+};
+
+/**
+ * \brief Структура запроса на прерывание ожидания измерения
+ *
+ * Структура принадлежит владельцу драйвера (см. DeviceSet) и передаётся в
+ * драйвер методом VnaDevice::set_abort_signal(). Поэтому запрос можно передать
+ * из любого потока, не обращаясь к объекту драйвера, который в это время может
+ * создаваться или удаляться.
+ */
+struct abort_signal_t {
+    /// Флаг, показывающий, что ожидание измерения требуется прервать
+    std::atomic<bool> requested = false;
+    /// Мьютекс условной переменной condition
+    std::mutex mutex{};
+    /// Условная переменная, которая прерывает ожидание при вызове request()
+    std::condition_variable condition{};
+
+    /**
+     * \brief Запрос на прерывание ожидания
+     *
+     * Если ожидание не выполняется, то запрос остаётся в силе до вызова reset().
+     */
+    void request() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requested = true;
+        }
+
+        condition.notify_all();
+    }
+
+    /**
+     * \brief Сброс запроса на прерывание ожидания
+     */
+    void reset() {
+        requested = false;
+    }
+
+    /**
+     * \brief Ожидание, которое прерывается вызовом request()
+     *
+     * \param [in] duration Длительность ожидания
+     *
+     * \return Если ожидание завершилось по времени - true. Если ожидание было
+     * прервано - false.
+     */
+    bool wait_for(std::chrono::microseconds duration) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return !condition.wait_for(lock, duration, [this]() { return requested.load(); });
+    }
+};
 
 /**
  * \brief Класс, в котором реализованы методы для работы с ВАЦ
@@ -74,6 +218,178 @@ protected:
     /// Тип измерения
     int meas_type = MEAS_TRANSITION;
 
+    /// Формат, в котором ВАЦ передаёт данные трасс
+    int data_format = DATA_FORMAT_ASCII;
+    /// Флаг, показывающий, передаются ли двоичные данные в обратном порядке байт (младшим байтом вперёд)
+    bool swapped_bytes = true;
+
+    /// Набор трасс, которые созданы на ВАЦ. Сбрасывается при сбросе настроек
+    trace_set_t active_traces{};
+
+    /// Запрос на прерывание ожидания измерения (см. set_abort_signal())
+    std::shared_ptr<abort_signal_t> abort_signal = std::make_shared<abort_signal_t>();
+
+    /**
+     * \brief Ожидание, которое прерывается запросом на остановку измерения
+     *
+     * \param [in] duration Длительность ожидания
+     *
+     * \return Если ожидание завершилось по времени - true. Если был получен
+     * запрос abort_signal - false.
+     */
+    bool wait_unless_aborted(std::chrono::microseconds duration) {
+        return abort_signal->wait_for(duration);
+    }
+
+    /**
+     * \brief Запрос количества проходов, которые ВАЦ выполняет за одно измерение
+     *
+     * При измерении коэффициента отражения ВАЦ выполняет отдельный проход для
+     * каждого порта созданных трасс.
+     *
+     * \return Количество проходов
+     */
+    size_t get_sweep_count() const {
+        return meas_type == MEAS_REFLECTION ? std::max<size_t>(1, active_traces.port_list.size()) : 1;
+    }
+
+    /// Составной запрос данных трасс, сформированный при последнем вызове get_data_list_query()
+    std::string data_list_query{};
+    /// Количество трасс, для которого сформирован составной запрос
+    int data_list_query_traces = 0;
+
+    /**
+     * \brief Формирование составного запроса данных нескольких трасс
+     *
+     * Запрос формируется только при изменении количества трасс, а в остальных
+     * случаях используется сохранённая строка.
+     *
+     * \param [in] query_format Формат запроса данных одной трассы, в который
+     * подставляется номер трассы
+     * \param [in] trace_count Количество трасс
+     *
+     * \return Запросы данных трасс с номерами от 1 до trace_count, разделённые
+     * символом RESPONSE_DELIMITER
+     */
+    const std::string &get_data_list_query(std::string_view query_format, int trace_count) {
+        if (trace_count != data_list_query_traces) {
+            data_list_query.clear();
+
+            for (int trace_num = 1; trace_num <= trace_count; ++trace_num) {
+                if (trace_num != 1) {
+                    data_list_query += RESPONSE_DELIMITER;
+                }
+
+                data_list_query += std::vformat(query_format, std::make_format_args(trace_num));
+            }
+
+            data_list_query_traces = trace_count;
+        }
+
+        return data_list_query;
+    }
+
+    /**
+     * \brief Чтение числа из двоичного блока данных с учётом порядка байт
+     *
+     * \param [in] source Указатель на первый байт числа
+     * \param [in] swapped_bytes Флаг, показывающий, передаются ли числа младшим байтом вперёд
+     *
+     * \return Прочитанное число
+     */
+    template <typename T>
+    static T read_binary_value(const char *source, bool swapped_bytes) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, source, sizeof(T));
+
+        if (swapped_bytes != (std::endian::native == std::endian::little)) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+
+        return value;
+    }
+
+    /**
+     * \brief Преобразует двоичный блок данных вида "i1,q1,i2,q2,..." в массивы квадратур
+     *
+     * Результат записывается в существующие массивы, поэтому, если их ёмкости
+     * достаточно, память не выделяется.
+     *
+     * \param [in] block Содержимое двоичного блока без заголовка
+     * \param [out] iq_data Результат измерений одного порта
+     * \param [in] max_points Максимальное количество точек, которое требуется прочитать.
+     * Если значение меньше или равно 0, то читаются все точки.
+     */
+    void parse_iq_block(const std::vector<char> &block, iq_port_data_t &iq_data, int max_points = 0) const {
+        size_t value_size = data_format == DATA_FORMAT_REAL32 ? sizeof(float) : sizeof(double);
+        size_t block_points = block.size() / (2 * value_size);
+
+        if (max_points > 0) {
+            block_points = std::min(block_points, (size_t) max_points);
+        }
+
+        iq_data.i.resize(block_points);
+        iq_data.q.resize(block_points);
+
+        for (size_t pos = 0; pos < block_points; ++pos) {
+            const char *point = block.data() + 2 * pos * value_size;
+
+            if (data_format == DATA_FORMAT_REAL32) {
+                iq_data.i[pos] = read_binary_value<float>(point, swapped_bytes);
+                iq_data.q[pos] = read_binary_value<float>(point + value_size, swapped_bytes);
+            } else {
+                iq_data.i[pos] = read_binary_value<double>(point, swapped_bytes);
+                iq_data.q[pos] = read_binary_value<double>(point + value_size, swapped_bytes);
+            }
+        }
+    }
+
+    /**
+     * \brief Преобразует ответ ВАЦ вида "i1,q1,i2,q2,..." в массивы квадратур
+     *
+     * \param [in] received_data Строка, полученная от ВАЦ
+     * \param [out] iq_data Результат измерений одного порта
+     * \param [in] max_points Максимальное количество точек, которое требуется прочитать.
+     * Если значение меньше или равно 0, то читаются все точки.
+     */
+    static void parse_iq_data(const std::string &received_data, iq_port_data_t &iq_data, int max_points = 0) {
+        number_utils::parse_pairs(
+                received_data.data(), received_data.data() + received_data.size(), DATA_DELIMITER,
+                iq_data.i, iq_data.q, max_points);
+    }
+
+    /**
+     * \brief Преобразует ответ ВАЦ на составной запрос вида "i1,q1,...;i1,q1,..."
+     * в массивы квадратур для нескольких трасс
+     *
+     * Ответы разделяются без создания промежуточных строк, а результаты записываются
+     * в существующие массивы.
+     *
+     * \param [in] received_data Строка, полученная от ВАЦ
+     * \param [in] trace_count Количество трасс в ответе
+     * \param [out] iq_data_list Результаты измерений для каждой трассы
+     * \param [in] max_points Максимальное количество точек, которое требуется прочитать
+     * для каждой трассы. Если значение меньше или равно 0, то читаются все точки.
+     */
+    static void parse_iq_data_list(
+            const std::string &received_data, int trace_count,
+            std::vector<iq_port_data_t> &iq_data_list, int max_points = 0) {
+        iq_data_list.resize(trace_count);
+
+        const char *begin = received_data.data();
+        const char *end = received_data.data() + received_data.size();
+
+        for (iq_port_data_t &iq_data : iq_data_list) {
+            const char *response_end = std::find(begin, end, RESPONSE_DELIMITER);
+
+            number_utils::parse_pairs(begin, response_end, DATA_DELIMITER, iq_data.i, iq_data.q, max_points);
+            begin = response_end < end ? response_end + 1 : end;
+        }
+    }
+
 public:
     VnaDevice() = default;
 
@@ -122,6 +438,9 @@ public:
      * \brief Создание необходимых трасс, в зависимости от того, используется ли внешний
      * генератор
      *
+     * Если на ВАЦ уже созданы трассы для того же списка портов, типа измерения,
+     * зондирующего порта и флага external, то команды на ВАЦ не отправляются.
+     *
      * \param [in] port_list Список портов, для которых неободимо создать трассы
      * \param [in] external Флаг, который показывает используется ли внешний генератор
      */
@@ -164,6 +483,13 @@ public:
      */
     virtual int get_switch_module_count() {return 0;}
 
+    /**
+     * \brief Запрос количества портов ВАЦ
+     *
+     * \return Количество портов
+     */
+    virtual int get_port_count() {return 0;}
+
     /**
      * \brief Отключает все порты
      */
@@ -188,6 +514,32 @@ public:
      */
     virtual void rf_on(int port) {};
 
+    /**
+     * \brief Отключает порты, которые были включены методом rf_on(const std::vector<int> &)
+     *
+     * \param [in] port_list Список портов
+     */
+    virtual void rf_off(const std::vector<int> &port_list) {
+        for (int port : port_list) {
+            rf_off(port);
+        }
+    }
+
+    /**
+     * \brief Включает порты для измерения коэффициента отражения за один запуск
+     * измерения
+     *
+     * Каждый порт из списка становится зондирующим на время своего прохода, поэтому
+     * после одного запуска измерения (trigger() и init()) данные всех трасс готовы.
+     *
+     * \param [in] port_list Список портов
+     */
+    virtual void rf_on(const std::vector<int> &port_list) {
+        for (int port : port_list) {
+            rf_on(port);
+        }
+    }
+
     /**
      * \brief Перевод триггера в режим manual
      */
@@ -198,14 +550,60 @@ public:
      */
     virtual void init() {};
 
+    /**
+     * \brief Включение или отключение выходного триггера, который формируется
+     * по завершении каждого измерения
+     *
+     * \param [in] enabled Флаг, показывающий, требуется ли формировать выходной триггер
+     */
+    virtual void set_trigger_output(bool enabled) {};
+
+    /**
+     * \brief Метод позволяет узнать, может ли ВАЦ формировать выходной триггер
+     *
+     * \return Если выходной триггер поддерживается, то возвращает true.
+     * В противном случае - false.
+     */
+    virtual bool has_trigger_output() {return false;}
+
+    /**
+     * \brief Установка формата, в котором ВАЦ передаёт данные трасс
+     *
+     * \param [in] data_format Формат данных (DATA_FORMAT_ASCII, DATA_FORMAT_REAL32
+     * или DATA_FORMAT_REAL64)
+     * \param [in] swapped_bytes Флаг, показывающий, требуется ли передавать двоичные
+     * данные младшим байтом вперёд
+     */
+    virtual void set_data_format(int data_format, bool swapped_bytes) {};
+
     /**
      * \brief Сбор данных, полученных в результате измерения, для одного порта
      *
+     * Данные записываются в существующую структуру, поэтому при повторных
+     * измерениях одной трассы память заново не выделяется.
+     *
      * \param [in] trace_index Индекс трассы, которая соответствует требуемому порту
+     * \param [out] iq_data Результат измерений одного порта
+     */
+    virtual void get_data(int trace_index, iq_port_data_t &iq_data) {iq_data.clear();};
+
+    /**
+     * \brief Сбор данных, полученных в результате измерения, для нескольких трасс
+     *
+     * По-умолчанию данные каждой трассы запрашиваются отдельно. Приборы, которые
+     * поддерживают составные запросы, получают данные всех трасс за одну транзакцию.
      *
-     * \return Результат измерений одного порта
+     * \param [in] trace_count Количество трасс. Запрашиваются трассы с индексами
+     * от 0 до trace_count - 1.
+     * \param [out] iq_data_list Результаты измерений для каждой трассы
      */
-    virtual iq_port_data_t get_data(int trace_index) {return iq_port_data_t{};};
+    virtual void get_data_list(int trace_count, std::vector<iq_port_data_t> &iq_data_list) {
+        iq_data_list.resize(trace_count);
+
+        for (int trace_index = 0; trace_index < trace_count; ++trace_index) {
+            get_data(trace_index, iq_data_list[trace_index]);
+        }
+    }
 
     /**
      * \brief Запрос номера зондирующего порта
@@ -216,6 +614,15 @@ public:
         return source_port;
     };
 
+    /**
+     * \brief Запрос типа измерения
+     *
+     * \return Тип измерения (MEAS_TRANSITION или MEAS_REFLECTION)
+     */
+    int get_meas_type() const {
+        return meas_type;
+    }
+
     /**
      * \brief Запрос начальной частоты диапазона
      *
@@ -242,6 +649,33 @@ public:
     int get_points() const {
         return points;
     }
+
+    /**
+     * \brief Оценка длительности одного измерения
+     *
+     * Время измерения одной точки обратно пропорционально ширине разрешающего
+     * фильтра, а количество проходов определяется методом get_sweep_count().
+     * Используется для расчёта таймаута ожидания измерения (см.
+     * VisaDevice::get_timeout()).
+     *
+     * \return Ориентировочная длительность измерения в секундах
+     */
+    virtual double get_sweep_time() const {
+        return rbw > 0 ? (double) get_sweep_count() * points / rbw : 0.0;
+    }
+
+    /**
+     * \brief Установка запроса на прерывание ожидания измерения
+     *
+     * Вызывается до начала измерений. Получив запрос, драйвер, который ожидает
+     * завершения измерения, останавливает его на приборе, сбрасывает запрос и
+     * бросает исключение antestl_exception с кодом ABORTED_CODE.
+     *
+     * \param [in] abort_signal Запрос, который принадлежит владельцу драйвера
+     */
+    void set_abort_signal(std::shared_ptr<abort_signal_t> abort_signal) {
+        this->abort_signal = std::move(abort_signal);
+    }
 };
 
 
@@ -13,6 +13,7 @@
 #include <condition_variable>
 
 #include "socket/socket_server.hpp"
+#include "devices/transport/transport.hpp"
 #include "task_manager.hpp"
 
 /// Версия AntestL Backend
@@ -52,6 +53,16 @@
 /// Параметр изменения порта для исходящих данных (укороченный)
 #define DATA_PORT_PARAM_SHORT       "-d"
 
+/// Параметр записи обмена с приборами в каталог файлов трассировки
+#define RECORD_PARAM                "-record"
+/// Параметр записи обмена с приборами в каталог файлов трассировки (укороченный)
+#define RECORD_PARAM_SHORT          "-rec"
+
+/// Параметр воспроизведения обмена с приборами из каталога файлов трассировки
+#define REPLAY_PARAM                "-replay"
+/// Параметр воспроизведения обмена с приборами из каталога файлов трассировки (укороченный)
+#define REPLAY_PARAM_SHORT          "-rep"
+
 /// Объект сокета входящих заданий
 SocketServer task_server(DEFAULT_TASK_PORT, TASK_SERVER_TAG);
 /// Объект сокета исходящих данных
@@ -116,6 +127,10 @@ int main(int argc, char* argv[]) {
             task_server.set_port(atoi(argv[++arg_pos]));
         } else if (strcmp(argv[arg_pos], DATA_PORT_PARAM) == 0 || strcmp(argv[arg_pos], DATA_PORT_PARAM_SHORT) == 0) {
             data_server.set_port(atoi(argv[++arg_pos]));
+        } else if (strcmp(argv[arg_pos], RECORD_PARAM) == 0 || strcmp(argv[arg_pos], RECORD_PARAM_SHORT) == 0) {
+            Transport::set_trace_mode(TRACE_MODE_RECORD, argv[++arg_pos]);
+        } else if (strcmp(argv[arg_pos], REPLAY_PARAM) == 0 || strcmp(argv[arg_pos], REPLAY_PARAM_SHORT) == 0) {
+            Transport::set_trace_mode(TRACE_MODE_REPLAY, argv[++arg_pos]);
         } else {
             usage();
             exit(0);
@@ -263,4 +278,6 @@ void usage() {
     std::cout << "-log   (-l) -- sets log level: [error, warn, info (default), debug, trace]" << std::endl;
     std::cout << "-task  (-t) -- sets task server port (default: 5006)" << std::endl;
     std::cout << "-data  (-d) -- sets data server port (default: 5007)" << std::endl;
+    std::cout << "-record (-rec) -- records device I/O to trace files in the given directory" << std::endl;
+    std::cout << "-replay (-rep) -- replays device I/O from trace files in the given directory" << std::endl;
 }
\ No newline at end of file
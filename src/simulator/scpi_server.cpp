@@ -0,0 +1,255 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса ScpiServer
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "scpi_server.hpp"
+#include "../utils/logger.hpp"
+
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+/// Тип дескриптора сокета
+typedef SOCKET native_socket_t;
+#else
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/// Тип дескриптора сокета
+typedef int native_socket_t;
+#endif
+
+/**
+ * \brief Закрытие сокета
+ *
+ * \param [in] handle Дескриптор сокета
+ */
+static void close_socket(native_socket_t handle) {
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif
+}
+
+/**
+ * \brief Ожидание данных или подключения на сокете
+ *
+ * \param [in] handle Дескриптор сокета
+ *
+ * \return Если сокет готов к чтению - 1. Если истёк интервал SCPI_SERVER_POLL_INTERVAL - 0.
+ * Если возникла ошибка - -1.
+ */
+static int wait_readable(native_socket_t handle) {
+    pollfd descriptor{};
+    descriptor.fd = handle;
+    descriptor.events = POLLIN;
+
+#ifdef _WIN32
+    int ready = WSAPoll(&descriptor, 1, SCPI_SERVER_POLL_INTERVAL);
+#else
+    int ready = poll(&descriptor, 1, SCPI_SERVER_POLL_INTERVAL);
+#endif
+
+    if (ready <= 0) {
+        return ready;
+    }
+
+    return (descriptor.revents & (POLLIN | POLLHUP)) != 0 ? 1 : -1;
+}
+
+/**
+ * \brief Деструктор, который останавливает сервер
+ */
+ScpiServer::~ScpiServer() {
+    stop();
+}
+
+/**
+ * \brief Запуск сервера
+ *
+ * Сокет привязывается ко всем адресам компьютера, после чего запускается поток
+ * приёма подключений.
+ *
+ * \return Если сервер запущен - true. В противном случае - false.
+ */
+bool ScpiServer::start() {
+#ifdef _WIN32
+    WSADATA wsa_data{};
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        logger::log(LEVEL_ERROR, "Can't initialize Winsock");
+        return false;
+    }
+#endif
+
+    native_socket_t handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+#ifdef _WIN32
+    if (handle == INVALID_SOCKET) {
+#else
+    if (handle < 0) {
+#endif
+        logger::log(LEVEL_ERROR, "Can't create socket for port {}", port);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(handle, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(handle, SCPI_SERVER_BACKLOG) != 0) {
+        logger::log(LEVEL_ERROR, "Can't listen on port {}", port);
+
+        close_socket(handle);
+        return false;
+    }
+
+    listen_handle = (std::intptr_t) handle;
+    running = true;
+
+    accept_thread = std::thread(&ScpiServer::accept_clients, this);
+
+    logger::log(LEVEL_INFO, "Listening on port {}", port);
+    return true;
+}
+
+/**
+ * \brief Остановка сервера
+ *
+ * Потоки сервера завершаются в течение SCPI_SERVER_POLL_INTERVAL миллисекунд.
+ */
+void ScpiServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    accept_thread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(client_mutex);
+
+        for (std::thread &client_thread : client_threads) {
+            client_thread.join();
+        }
+
+        client_threads.clear();
+    }
+
+    close_socket((native_socket_t) listen_handle);
+    listen_handle = -1;
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/**
+ * \brief Приём подключений до остановки сервера
+ */
+void ScpiServer::accept_clients() {
+    while (running) {
+        if (wait_readable((native_socket_t) listen_handle) <= 0) {
+            continue;
+        }
+
+        native_socket_t client = accept((native_socket_t) listen_handle, nullptr, nullptr);
+
+#ifdef _WIN32
+        if (client == INVALID_SOCKET) {
+#else
+        if (client < 0) {
+#endif
+            continue;
+        }
+
+        int no_delay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&no_delay), sizeof(no_delay));
+
+        logger::log(LEVEL_DEBUG, "Client connected to port {}", port);
+
+        std::lock_guard<std::mutex> lock(client_mutex);
+        client_threads.emplace_back(&ScpiServer::serve, this, (std::intptr_t) client);
+    }
+}
+
+/**
+ * \brief Обслуживание одного подключения
+ *
+ * Каждая полученная посылка передаётся прибору, а его ответ, если он есть,
+ * отправляется клиенту.
+ *
+ * \param [in] client_handle Дескриптор сокета клиента
+ */
+void ScpiServer::serve(std::intptr_t client_handle) {
+    auto client = (native_socket_t) client_handle;
+
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    std::string received{};
+    char buffer[SCPI_SERVER_BUFFER_SIZE];
+
+    while (running) {
+        int ready = wait_readable(client);
+
+        if (ready == 0) {
+            continue;
+        }
+
+        auto length = ready < 0 ? -1 : recv(client, buffer, sizeof(buffer), 0);
+
+        if (length <= 0) {
+            break;
+        }
+
+        received.append(buffer, length);
+
+        size_t line_begin = 0;
+        size_t line_end;
+
+        while ((line_end = received.find_first_of("\r\n", line_begin)) != std::string::npos) {
+            std::string reply = instrument.process(std::string_view(received).substr(line_begin, line_end - line_begin));
+            line_begin = line_end + 1;
+
+            if (reply.empty()) {
+                continue;
+            }
+
+            reply += '\n';
+
+            for (size_t sent = 0; sent < reply.size();) {
+                auto count = send(client, reply.data() + sent, (int) (reply.size() - sent), flags);
+
+                if (count <= 0) {
+                    break;
+                }
+
+                sent += count;
+            }
+        }
+
+        received.erase(0, line_begin);
+    }
+
+    logger::log(LEVEL_DEBUG, "Client disconnected from port {}", port);
+    close_socket(client);
+}
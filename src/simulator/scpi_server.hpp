@@ -0,0 +1,67 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс ScpiServer
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SCPI_SERVER_HPP
+#define ANTESTL_BACKEND_SCPI_SERVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include "simulated_instrument.hpp"
+
+/// Интервал, с которым потоки сервера проверяют запрос на остановку, в миллисекундах
+#define SCPI_SERVER_POLL_INTERVAL   200
+/// Размер буфера приёма команд
+#define SCPI_SERVER_BUFFER_SIZE     4096
+/// Длина очереди входящих подключений
+#define SCPI_SERVER_BACKLOG         4
+
+/**
+ * \brief Класс TCP-сервера, который передаёт команды SCPI симулируемому прибору
+ *
+ * Сервер принимает подключения на заданном порту (как приборы с адресами вида
+ * "TCPIP0::<хост>::<порт>::SOCKET") и обслуживает каждое подключение в отдельном
+ * потоке. Посылки от клиента заканчиваются символом '\n' или '\r', а ответы
+ * прибора отправляются с символом '\n' в конце.
+ */
+class ScpiServer {
+    /// Симулируемый прибор
+    SimulatedInstrument &instrument;
+    /// Порт сервера
+    uint16_t port;
+
+    /// Дескриптор сокета, принимающего подключения. Если сокет не открыт, то -1.
+    std::intptr_t listen_handle = -1;
+    /// Флаг, показывающий, работает ли сервер
+    std::atomic<bool> running = false;
+
+    /// Поток приёма подключений
+    std::thread accept_thread{};
+    /// Потоки обслуживания подключений
+    std::list<std::thread> client_threads{};
+    /// Мьютекс, который защищает список client_threads
+    std::mutex client_mutex{};
+
+    void accept_clients();
+    void serve(std::intptr_t client_handle);
+
+public:
+    ScpiServer(SimulatedInstrument &instrument, uint16_t port) : instrument(instrument), port(port) {};
+    ~ScpiServer();
+
+    ScpiServer(const ScpiServer &) = delete;
+    ScpiServer &operator=(const ScpiServer &) = delete;
+
+    bool start();
+    void stop();
+};
+
+#endif //ANTESTL_BACKEND_SCPI_SERVER_HPP
@@ -0,0 +1,99 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса SimulatedAxis
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "simulated_axis.hpp"
+
+#include <charconv>
+#include <cmath>
+
+/**
+ * \brief Запуск перемещения оси в заданное положение
+ *
+ * \param [in] pos Требуемое положение в единицах положения оси
+ */
+void SimulatedAxis::start_move(double pos) {
+    auto now = std::chrono::steady_clock::now();
+    double speed = config.velocity * SIM_AXIS_SCALE;
+    double move_time = speed > 0 ? std::abs(pos - position()) / speed : 0;
+
+    start_pos = position();
+    target_pos = pos;
+
+    move_begin = now;
+    move_end = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(move_time));
+    settled = move_end + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(config.settle_time));
+}
+
+/**
+ * \brief Расчёт текущего положения оси
+ *
+ * \return Положение в единицах положения оси
+ */
+double SimulatedAxis::position() const {
+    auto now = std::chrono::steady_clock::now();
+
+    if (now >= move_end) {
+        return target_pos;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - move_begin).count();
+    double travelled = elapsed * config.velocity * SIM_AXIS_SCALE;
+
+    return target_pos > start_pos ? start_pos + travelled : start_pos - travelled;
+}
+
+/**
+ * \brief Выполнение команды привода оси
+ *
+ * \param [in] header Команда
+ * \param [in] argument Аргументы команды
+ *
+ * \return Ответ на запросы TRJSTAT и PFB. Для остальных команд - пустая строка.
+ */
+std::string SimulatedAxis::execute(std::string_view header, std::string_view argument) {
+    std::string command = normalize(header);
+    std::string reply{};
+
+    if (command == "TRJSTAT") {
+        auto now = std::chrono::steady_clock::now();
+        long long status = ref_set ? SIM_AXIS_BIT_REF_SET : 0;
+
+        if (now < move_end) {
+            status |= SIM_AXIS_BIT_MOVE_BLOCK;
+        } else if (now >= settled) {
+            status |= SIM_AXIS_BIT_IN_POS;
+        }
+
+        char buffer[24]{};
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), status, 16);
+
+        reply += SIM_AXIS_STATUS_PREFIX;
+        reply.append(buffer, result.ptr);
+    } else if (command == "PFB") {
+        reply = std::to_string(std::lround(position()));
+    } else if (command == "ORDER") {
+        size_t pos_begin = argument.find(' ');
+        order_pos = pos_begin == std::string_view::npos ? 0 : parse_number(argument.substr(pos_begin + 1));
+    } else if (command == "MOVE") {
+        start_move(order_pos);
+    } else if (command == "MH") {
+        ref_set = true;
+        start_move(0);
+    } else if (command == "STOP") {
+        double pos = position();
+
+        start_pos = target_pos = pos;
+        move_end = std::chrono::steady_clock::now();
+        settled = move_end + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(config.settle_time));
+    }
+
+    return reply;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс SimulatedAxis
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SIMULATED_AXIS_HPP
+#define ANTESTL_BACKEND_SIMULATED_AXIS_HPP
+
+#include "simulated_instrument.hpp"
+
+/// Количество единиц положения оси на один градус
+#define SIM_AXIS_SCALE              10000
+
+/// Бит статуса оси: выполнен поиск нулевого положения
+#define SIM_AXIS_BIT_REF_SET        0x00020000
+/// Бит статуса оси: ось находится в заданном положении
+#define SIM_AXIS_BIT_IN_POS         0x00080000
+/// Бит статуса оси: выполняется перемещение
+#define SIM_AXIS_BIT_MOVE_BLOCK     0x00010000
+
+/// Префикс ответа на запрос статуса оси
+#define SIM_AXIS_STATUS_PREFIX      'H'
+
+/**
+ * \brief Класс симулируемой оси ОПУ
+ *
+ * Реализует команды привода оси, которые использует драйвер TesartRbd:
+ * TRJSTAT (статус в шестнадцатеричном виде), ORDER и MOVE (перемещение в
+ * заданное положение), MH (поиск нулевого положения), STOP и PFB (текущее
+ * положение). Ось движется со скоростью simulator_config_t::velocity, а после
+ * остановки ещё simulator_config_t::settle_time секунд не считается находящейся
+ * в положении.
+ */
+class SimulatedAxis : public SimulatedInstrument {
+    /// Положение, из которого началось перемещение
+    double start_pos = 0;
+    /// Положение, в которое выполняется перемещение
+    double target_pos = 0;
+    /// Положение, заданное последней командой ORDER
+    double order_pos = 0;
+
+    /// Момент начала перемещения
+    std::chrono::steady_clock::time_point move_begin{};
+    /// Момент окончания перемещения
+    std::chrono::steady_clock::time_point move_end{};
+    /// Момент, начиная с которого ось находится в положении
+    std::chrono::steady_clock::time_point settled{};
+
+    /// Флаг, показывающий, выполнен ли поиск нулевого положения
+    bool ref_set = false;
+
+    void start_move(double pos);
+    double position() const;
+
+protected:
+    std::string execute(std::string_view header, std::string_view argument) override;
+
+public:
+    explicit SimulatedAxis(const simulator_config_t &config) : SimulatedInstrument(config) {};
+};
+
+#endif //ANTESTL_BACKEND_SIMULATED_AXIS_HPP
@@ -0,0 +1,79 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса SimulatedGen
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "simulated_gen.hpp"
+
+/**
+ * \brief Конструктор симулируемого генератора
+ *
+ * \param [in] config Параметры симуляции
+ */
+SimulatedGen::SimulatedGen(const simulator_config_t &config) :
+        ScpiInstrument(config, SIM_IDN_KEYSIGHT_GEN, SIM_NO_ERROR_KEYSIGHT) {}
+
+/**
+ * \brief Возврат генератора в режим CW
+ */
+void SimulatedGen::reset() {
+    freq = SIM_GEN_DEFAULT_FREQ;
+
+    freq_list.clear();
+    list_point = 0;
+    list_mode = false;
+}
+
+/**
+ * \brief Выполнение команд установки частоты и перестройки по списку
+ *
+ * \param [in] header Заголовок команды
+ * \param [in] argument Аргументы команды
+ * \param [out] reply Ответ на запрос
+ *
+ * \return Если команда обработана - true. В противном случае - false.
+ */
+bool SimulatedGen::execute_specific(std::string_view header, std::string_view argument, std::string &reply) {
+    bool query = header.ends_with('?');
+
+    if (match(header, "[SOURce]:FREQuency:[CW]")) {
+        if (query) {
+            append_number(reply, list_mode && list_point < freq_list.size() ? freq_list[list_point] : freq);
+        } else {
+            freq = parse_number(argument);
+            start_operation(config.settle_time);
+        }
+    } else if (match(header, "[SOURce]:FREQuency:MODE")) {
+        if (query) {
+            reply = list_mode ? "LIST" : "CW";
+        } else {
+            list_mode = normalize(argument) == "LIST";
+            list_point = 0;
+
+            start_operation(config.settle_time);
+        }
+    } else if (match(header, "[SOURce]:LIST:FREQuency") && !query) {
+        freq_list.clear();
+
+        while (!argument.empty()) {
+            size_t delimiter = argument.find(',');
+
+            freq_list.push_back(parse_number(argument.substr(0, delimiter)));
+            argument = delimiter == std::string_view::npos ? std::string_view{} : argument.substr(delimiter + 1);
+        }
+    } else if (match(header, "*TRG")) {
+        if (list_mode && list_point + 1 < freq_list.size()) {
+            ++list_point;
+            start_operation(config.settle_time);
+        }
+    } else if (match(header, "INITiate:[IMMediate]")) {
+        list_point = 0;
+    } else if (!match(header, "ABORt")) {
+        return false;
+    }
+
+    return true;
+}
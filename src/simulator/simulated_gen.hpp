@@ -0,0 +1,48 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс SimulatedGen
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SIMULATED_GEN_HPP
+#define ANTESTL_BACKEND_SIMULATED_GEN_HPP
+
+#include <vector>
+
+#include "simulated_instrument.hpp"
+
+/// Ответ на запрос *IDN? симулируемого генератора
+#define SIM_IDN_KEYSIGHT_GEN        "Keysight Technologies,N5183B,SIM0000001,B.01.86"
+/// Частота генератора по умолчанию в Гц
+#define SIM_GEN_DEFAULT_FREQ        1e9
+
+/**
+ * \brief Класс симулируемого генератора сигналов
+ *
+ * Реализует подмножество команд SCPI, которое использует драйвер KeysightGen:
+ * установку частоты, загрузку списка частот (LIST:FREQuency, FREQuency:MODE LIST)
+ * и переход по списку по команде *TRG. Каждая перестройка частоты длится
+ * simulator_config_t::settle_time секунд.
+ */
+class SimulatedGen : public ScpiInstrument {
+    /// Частота в режиме CW в Гц
+    double freq = SIM_GEN_DEFAULT_FREQ;
+
+    /// Список частот в Гц
+    std::vector<double> freq_list{};
+    /// Номер текущей точки списка частот
+    size_t list_point = 0;
+    /// Флаг, показывающий, включён ли режим перестройки по списку
+    bool list_mode = false;
+
+protected:
+    bool execute_specific(std::string_view header, std::string_view argument, std::string &reply) override;
+    void reset() override;
+
+public:
+    explicit SimulatedGen(const simulator_config_t &config);
+};
+
+#endif //ANTESTL_BACKEND_SIMULATED_GEN_HPP
@@ -0,0 +1,404 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для классов
+ * SimulatedInstrument и ScpiInstrument
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "simulated_instrument.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Разделение строки на части по символу
+ *
+ * \param [in] source Исходная строка
+ * \param [in] delimiter Символ-разделитель
+ * \param [in] skip_quoted Если true, то разделители внутри кавычек не учитываются
+ *
+ * \return Список частей строки
+ */
+static std::vector<std::string_view> split(std::string_view source, char delimiter, bool skip_quoted = false) {
+    std::vector<std::string_view> parts{};
+
+    bool quoted = false;
+    size_t begin = 0;
+
+    for (size_t pos = 0; pos < source.size(); ++pos) {
+        if (skip_quoted && source[pos] == '"') {
+            quoted = !quoted;
+        } else if (source[pos] == delimiter && !quoted) {
+            parts.push_back(source.substr(begin, pos - begin));
+            begin = pos + 1;
+        }
+    }
+
+    parts.push_back(source.substr(begin));
+    return parts;
+}
+
+/**
+ * \brief Удаление пробельных символов в начале и в конце строки
+ *
+ * \param [in] source Исходная строка
+ *
+ * \return Строка без пробельных символов по краям
+ */
+static std::string_view trim(std::string_view source) {
+    while (!source.empty() && std::isspace((unsigned char) source.front())) {
+        source.remove_prefix(1);
+    }
+
+    while (!source.empty() && std::isspace((unsigned char) source.back())) {
+        source.remove_suffix(1);
+    }
+
+    return source;
+}
+
+/**
+ * \brief Сравнение двух строк без учёта регистра
+ *
+ * \param [in] first Первая строка
+ * \param [in] second Вторая строка
+ *
+ * \return Если строки совпадают - true. В противном случае - false.
+ */
+static bool equals_ignore_case(std::string_view first, std::string_view second) {
+    if (first.size() != second.size()) {
+        return false;
+    }
+
+    for (size_t pos = 0; pos < first.size(); ++pos) {
+        if (std::toupper((unsigned char) first[pos]) != std::toupper((unsigned char) second[pos])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Сравнение узла заголовка команды с узлом шаблона
+ *
+ * Узел шаблона записывается в нотации SCPI: заглавные буквы образуют короткую
+ * форму, а все буквы - длинную (например, "CALCulate"). Символ '#' в конце
+ * узла шаблона означает, что узел может заканчиваться числовым суффиксом.
+ *
+ * \param [in] node Узел заголовка команды
+ * \param [in] pattern Узел шаблона
+ * \param [out] suffix Числовой суффикс узла. Если суффикса нет - 1.
+ *
+ * \return Если узел соответствует шаблону - true. В противном случае - false.
+ */
+static bool match_node(std::string_view node, std::string_view pattern, int &suffix) {
+    suffix = 1;
+
+    if (!pattern.empty() && pattern.back() == '#') {
+        pattern.remove_suffix(1);
+
+        size_t digits_begin = node.size();
+
+        while (digits_begin > 0 && std::isdigit((unsigned char) node[digits_begin - 1])) {
+            --digits_begin;
+        }
+
+        if (digits_begin < node.size()) {
+            suffix = std::stoi(std::string(node.substr(digits_begin)));
+            node = node.substr(0, digits_begin);
+        }
+    }
+
+    size_t short_size = 0;
+
+    while (short_size < pattern.size() && !std::islower((unsigned char) pattern[short_size])) {
+        ++short_size;
+    }
+
+    return equals_ignore_case(node, pattern) || equals_ignore_case(node, pattern.substr(0, short_size));
+}
+
+/**
+ * \brief Сравнение узлов заголовка команды с узлами шаблона, начиная с заданных позиций
+ *
+ * Узлы шаблона в квадратных скобках могут отсутствовать в заголовке.
+ *
+ * \param [in] nodes Узлы заголовка команды
+ * \param [in] node_pos Позиция в списке узлов заголовка
+ * \param [in] patterns Узлы шаблона
+ * \param [in] pattern_pos Позиция в списке узлов шаблона
+ * \param [out] suffix Числовой суффикс первого узла шаблона с символом '#'
+ *
+ * \return Если заголовок соответствует шаблону - true. В противном случае - false.
+ */
+static bool match_nodes(const std::vector<std::string_view> &nodes, size_t node_pos,
+                        const std::vector<std::string_view> &patterns, size_t pattern_pos, int &suffix) {
+    if (pattern_pos == patterns.size()) {
+        return node_pos == nodes.size();
+    }
+
+    std::string_view pattern = patterns[pattern_pos];
+    bool optional = pattern.starts_with('[') && pattern.ends_with(']');
+
+    if (optional) {
+        pattern = pattern.substr(1, pattern.size() - 2);
+
+        if (match_nodes(nodes, node_pos, patterns, pattern_pos + 1, suffix)) {
+            return true;
+        }
+    }
+
+    int node_suffix = 1;
+
+    if (node_pos == nodes.size() || !match_node(nodes[node_pos], pattern, node_suffix)) {
+        return false;
+    }
+
+    if (!match_nodes(nodes, node_pos + 1, patterns, pattern_pos + 1, suffix)) {
+        return false;
+    }
+
+    if (pattern.ends_with('#')) {
+        suffix = node_suffix;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Проверка соответствия заголовка команды шаблону в нотации SCPI
+ *
+ * Начальный символ ':' и завершающий символ '?' заголовка не учитываются.
+ *
+ * \param [in] header Заголовок команды
+ * \param [in] pattern Шаблон (например, "CALCulate:MEASure#:DATA:SDATA" или "[SOURce]:POWer")
+ * \param [out] suffix Числовой суффикс узла шаблона с символом '#'
+ *
+ * \return Если заголовок соответствует шаблону - true. В противном случае - false.
+ */
+bool SimulatedInstrument::match(std::string_view header, std::string_view pattern, int *suffix) {
+    if (header.starts_with(SIM_HEADER_DELIMITER)) {
+        header.remove_prefix(1);
+    }
+
+    if (header.ends_with('?')) {
+        header.remove_suffix(1);
+    }
+
+    if (header.starts_with('*') || pattern.starts_with('*')) {
+        return equals_ignore_case(header, pattern);
+    }
+
+    int node_suffix = 1;
+    bool matched = match_nodes(split(header, SIM_HEADER_DELIMITER), 0, split(pattern, SIM_HEADER_DELIMITER), 0,
+                               node_suffix);
+
+    if (matched && suffix != nullptr) {
+        *suffix = node_suffix;
+    }
+
+    return matched;
+}
+
+/**
+ * \brief Приведение заголовка команды к виду, который используется как ключ
+ * таблицы настроек
+ *
+ * \param [in] header Заголовок команды
+ *
+ * \return Заголовок заглавными буквами без символов ':' в начале и '?' в конце
+ */
+std::string SimulatedInstrument::normalize(std::string_view header) {
+    if (header.starts_with(SIM_HEADER_DELIMITER)) {
+        header.remove_prefix(1);
+    }
+
+    if (header.ends_with('?')) {
+        header.remove_suffix(1);
+    }
+
+    std::string key(header);
+
+    for (char &symbol : key) {
+        symbol = (char) std::toupper((unsigned char) symbol);
+    }
+
+    return key;
+}
+
+/**
+ * \brief Преобразование аргумента команды в число
+ *
+ * \param [in] argument Аргумент команды
+ *
+ * \return Число. Если аргумент не является числом - 0.
+ */
+double SimulatedInstrument::parse_number(std::string_view argument) {
+    if (argument.starts_with('+')) {
+        argument.remove_prefix(1);
+    }
+
+    double value = 0;
+    std::from_chars(argument.data(), argument.data() + argument.size(), value);
+
+    return value;
+}
+
+/**
+ * \brief Добавление числа в конец строки в кратчайшей точной записи
+ *
+ * \param [in,out] destination Строка, в которую добавляется число
+ * \param [in] value Число
+ */
+void SimulatedInstrument::append_number(std::string &destination, double value) {
+    char buffer[32]{};
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+    destination.append(buffer, result.ptr);
+}
+
+/**
+ * \brief Обработка посылки, полученной от клиента
+ *
+ * \param [in] line Посылка без символа окончания
+ *
+ * \return Ответы на запросы, разделённые символом SIM_COMMAND_DELIMITER. Если
+ * запросов в посылке не было - пустая строка.
+ */
+std::string SimulatedInstrument::process(std::string_view line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string replies{};
+    bool has_reply = false;
+
+    for (std::string_view command : split(line, SIM_COMMAND_DELIMITER, true)) {
+        command = trim(command);
+
+        if (command.empty()) {
+            continue;
+        }
+
+        size_t header_end = 0;
+
+        while (header_end < command.size() && !std::isspace((unsigned char) command[header_end])) {
+            ++header_end;
+        }
+
+        std::string_view header = command.substr(0, header_end);
+        std::string reply = execute(header, trim(command.substr(header_end)));
+
+        if (header.ends_with('?') || !reply.empty()) {
+            if (has_reply) {
+                replies += SIM_COMMAND_DELIMITER;
+            }
+
+            replies += reply;
+            has_reply = true;
+        }
+    }
+
+    return replies;
+}
+
+/**
+ * \brief Конструктор прибора с общими командами IEEE 488.2
+ *
+ * \param [in] config Параметры симуляции
+ * \param [in] identity Ответ на запрос *IDN?
+ * \param [in] no_error Ответ на запрос SYSTem:ERRor?, если ошибок нет
+ */
+ScpiInstrument::ScpiInstrument(const simulator_config_t &config, std::string identity, std::string no_error) :
+        SimulatedInstrument(config), identity(std::move(identity)), no_error(std::move(no_error)) {}
+
+/**
+ * \brief Запуск длительной операции
+ *
+ * \param [in] duration Длительность операции в секундах
+ */
+void ScpiInstrument::start_operation(double duration) {
+    busy_until = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(duration));
+}
+
+/**
+ * \brief Ожидание завершения длительной операции
+ */
+void ScpiInstrument::wait_operation() const {
+    std::this_thread::sleep_until(busy_until);
+}
+
+/**
+ * \brief Проверка выполнения длительной операции
+ *
+ * \return Если операция ещё выполняется - true. В противном случае - false.
+ */
+bool ScpiInstrument::is_busy() const {
+    return std::chrono::steady_clock::now() < busy_until;
+}
+
+/**
+ * \brief Выполнение общих команд IEEE 488.2, команд прибора и команд настройки
+ *
+ * \param [in] header Заголовок команды
+ * \param [in] argument Аргументы команды
+ *
+ * \return Ответ на запрос. Для команд, не являющихся запросами, - пустая строка.
+ */
+std::string ScpiInstrument::execute(std::string_view header, std::string_view argument) {
+    if (opc_armed && !is_busy()) {
+        esr |= SIM_ESR_OPC;
+        opc_armed = false;
+    }
+
+    bool query = header.ends_with('?');
+
+    if (match(header, "*IDN") && query) {
+        return identity;
+    } else if (match(header, "*RST")) {
+        settings.clear();
+        busy_until = std::chrono::steady_clock::now();
+        reset();
+    } else if (match(header, "*CLS")) {
+        esr = 0;
+        opc_armed = false;
+    } else if (match(header, "*OPC")) {
+        if (query) {
+            wait_operation();
+            return "1";
+        }
+
+        opc_armed = true;
+    } else if (match(header, "*WAI")) {
+        wait_operation();
+    } else if (match(header, "*ESR") && query) {
+        int status = esr;
+        esr = 0;
+
+        return std::to_string(status);
+    } else if (match(header, "*STB") && query) {
+        return std::to_string(esr != 0 ? SIM_STB_ESB : 0);
+    } else if (match(header, "SYSTem:ERRor") && query) {
+        return no_error;
+    } else {
+        std::string reply{};
+
+        if (execute_specific(header, argument, reply)) {
+            return reply;
+        }
+
+        std::string key = normalize(header);
+
+        if (query) {
+            auto setting = settings.find(key);
+            return setting == settings.end() ? "0" : setting->second;
+        }
+
+        settings[key] = argument;
+    }
+
+    return std::string{};
+}
@@ -0,0 +1,147 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определены классы SimulatedInstrument и
+ * ScpiInstrument, а также параметры симуляции приборов
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SIMULATED_INSTRUMENT_HPP
+#define ANTESTL_BACKEND_SIMULATED_INSTRUMENT_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/// Стандартная длительность одного измерения ВАЦ в секундах
+#define SIM_DEFAULT_SWEEP_TIME      0.05
+/// Стандартное время установления частоты генератора и остановки оси ОПУ в секундах
+#define SIM_DEFAULT_SETTLE_TIME     0.01
+/// Стандартная скорость вращения оси ОПУ в градусах в секунду
+#define SIM_DEFAULT_VELOCITY        50.0
+
+/// Разделитель команд в одной посылке
+#define SIM_COMMAND_DELIMITER       ';'
+/// Разделитель узлов заголовка команды SCPI
+#define SIM_HEADER_DELIMITER        ':'
+
+/// Ответ на запрос SYSTem:ERRor? приборов Keysight, если ошибок нет
+#define SIM_NO_ERROR_KEYSIGHT       "+0,\"No error\""
+/// Ответ на запрос SYSTem:ERRor? приборов Planar, если ошибок нет
+#define SIM_NO_ERROR_PLANAR         "0,\"No error\""
+
+/// Бит OPC регистра ESR
+#define SIM_ESR_OPC                 0x01
+/// Бит ESB байта состояния
+#define SIM_STB_ESB                 0x20
+
+/**
+ * \brief Параметры симуляции приборов
+ */
+struct simulator_config_t {
+    /// Длительность одного измерения ВАЦ в секундах
+    double sweep_time = SIM_DEFAULT_SWEEP_TIME;
+    /// Время установления частоты генератора и остановки оси ОПУ в секундах
+    double settle_time = SIM_DEFAULT_SETTLE_TIME;
+    /// Скорость вращения оси ОПУ в градусах в секунду
+    double velocity = SIM_DEFAULT_VELOCITY;
+};
+
+/**
+ * \brief Базовый класс симулируемого прибора
+ *
+ * Прибор получает посылки от ScpiServer, разделяет их на команды по символу
+ * SIM_COMMAND_DELIMITER и выполняет команды по порядку. Ответы на запросы
+ * объединяются через тот же символ, как это делают приборы с SCPI. Все
+ * подключения к прибору обслуживаются по очереди.
+ */
+class SimulatedInstrument {
+    /// Мьютекс, который не позволяет выполнять команды нескольких подключений одновременно
+    std::mutex mutex{};
+
+protected:
+    /// Параметры симуляции
+    simulator_config_t config;
+
+    static bool match(std::string_view header, std::string_view pattern, int *suffix = nullptr);
+    static std::string normalize(std::string_view header);
+
+    static double parse_number(std::string_view argument);
+    static void append_number(std::string &destination, double value);
+
+    /**
+     * \brief Выполнение одной команды
+     *
+     * \param [in] header Заголовок команды (для запросов заканчивается символом '?')
+     * \param [in] argument Аргументы команды
+     *
+     * \return Ответ на команду. Если команда не требует ответа - пустая строка.
+     */
+    virtual std::string execute(std::string_view header, std::string_view argument) = 0;
+
+public:
+    explicit SimulatedInstrument(const simulator_config_t &config) : config(config) {};
+    virtual ~SimulatedInstrument() = default;
+
+    std::string process(std::string_view line);
+};
+
+/**
+ * \brief Базовый класс симулируемого прибора с общими командами IEEE 488.2
+ *
+ * Поддерживаются команды *IDN?, *RST, *CLS, *OPC, *OPC?, *ESR?, *ESE, *SRE,
+ * *STB?, *WAI и SYSTem:ERRor?. Длительные операции (измерение, установка частоты)
+ * задаются моментом busy_until: запрос *OPC? отвечает только после него, а бит
+ * OPC регистра ESR устанавливается после него, если была получена команда *OPC.
+ *
+ * Команды, которые прибор не обрабатывает отдельно, сохраняются в таблицу
+ * settings, а запрос с тем же заголовком возвращает сохранённое значение.
+ */
+class ScpiInstrument : public SimulatedInstrument {
+    /// Регистр ESR
+    int esr = 0;
+    /// Флаг, показывающий, что была получена команда *OPC
+    bool opc_armed = false;
+
+protected:
+    /// Момент завершения текущей длительной операции
+    std::chrono::steady_clock::time_point busy_until{};
+    /// Значения настроек, которые не обрабатываются прибором отдельно
+    std::map<std::string, std::string> settings{};
+
+    /// Ответ на запрос *IDN?
+    std::string identity;
+    /// Ответ на запрос SYSTem:ERRor?, если ошибок нет
+    std::string no_error;
+
+    void start_operation(double duration);
+    void wait_operation() const;
+    bool is_busy() const;
+
+    std::string execute(std::string_view header, std::string_view argument) override;
+
+    /**
+     * \brief Выполнение команды, специфичной для прибора
+     *
+     * \param [in] header Заголовок команды
+     * \param [in] argument Аргументы команды
+     * \param [out] reply Ответ на запрос
+     *
+     * \return Если команда обработана - true. В противном случае - false, и команда
+     * обрабатывается как настройка.
+     */
+    virtual bool execute_specific(std::string_view header, std::string_view argument, std::string &reply) = 0;
+
+    /**
+     * \brief Сброс состояния прибора по команде *RST
+     */
+    virtual void reset() {};
+
+public:
+    ScpiInstrument(const simulator_config_t &config, std::string identity, std::string no_error);
+};
+
+#endif //ANTESTL_BACKEND_SIMULATED_INSTRUMENT_HPP
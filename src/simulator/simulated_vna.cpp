@@ -0,0 +1,203 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса SimulatedVna
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "simulated_vna.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+/**
+ * \brief Конструктор симулируемого ВАЦ
+ *
+ * \param [in] config Параметры симуляции
+ * \param [in] model Модель ВАЦ SIM_VNA_*
+ */
+SimulatedVna::SimulatedVna(const simulator_config_t &config, int model) :
+        ScpiInstrument(config,
+                       model == SIM_VNA_PLANAR_S50244 ? SIM_IDN_PLANAR_S50244 : SIM_IDN_KEYSIGHT_M9807A,
+                       model == SIM_VNA_PLANAR_S50244 ? SIM_NO_ERROR_PLANAR : SIM_NO_ERROR_KEYSIGHT),
+        model(model) {}
+
+/**
+ * \brief Возврат настроек измерения к значениям по умолчанию
+ */
+void SimulatedVna::reset() {
+    points = SIM_VNA_DEFAULT_POINTS;
+    start_freq = SIM_VNA_DEFAULT_START_FREQ;
+    stop_freq = SIM_VNA_DEFAULT_STOP_FREQ;
+
+    data_format = SIM_FORMAT_ASCII;
+    swapped_bytes = false;
+
+    source_ports.clear();
+}
+
+/**
+ * \brief Учёт зондирующего порта новой трассы
+ *
+ * В аргументе команды ищется S-параметр вида "S<порт приёма><зондирующий порт>".
+ * Трассы отношений приёмников (при внешнем генераторе) зондирующих портов ВАЦ не
+ * используют.
+ *
+ * \param [in] argument Аргументы команды создания трассы
+ */
+void SimulatedVna::define_trace(std::string_view argument) {
+    for (size_t pos = argument.size(); pos >= 3; --pos) {
+        std::string_view parameter = argument.substr(pos - 3, 3);
+
+        if ((parameter[0] == 'S' || parameter[0] == 's') && std::isdigit((unsigned char) parameter[1]) &&
+                std::isdigit((unsigned char) parameter[2])) {
+            source_ports.insert(parameter[2] - '0');
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Формирование данных трассы в текущем формате
+ *
+ * \param [in] trace_num Номер трассы
+ *
+ * \return Пары I/Q, разделённые запятой, или двоичный блок в формате IEEE 488.2
+ */
+std::string SimulatedVna::trace_data(int trace_num) const {
+    double delay = trace_num * SIM_VNA_TRACE_DELAY;
+    double amplitude = 1.0 / (1 + trace_num);
+    double freq_step = points > 1 ? (stop_freq - start_freq) / (points - 1) : 0;
+
+    std::string data{};
+    std::string values{};
+
+    size_t value_size = data_format == SIM_FORMAT_REAL32 ? sizeof(float) : sizeof(double);
+    bool reverse = swapped_bytes != (std::endian::native == std::endian::little);
+
+    auto append_binary = [&](double value) {
+        char bytes[sizeof(double)]{};
+
+        if (data_format == SIM_FORMAT_REAL32) {
+            auto single = (float) value;
+            std::memcpy(bytes, &single, sizeof(single));
+        } else {
+            std::memcpy(bytes, &value, sizeof(value));
+        }
+
+        if (reverse) {
+            std::reverse(bytes, bytes + value_size);
+        }
+
+        values.append(bytes, value_size);
+    };
+
+    for (int point = 0; point < points; ++point) {
+        double phase = -2 * std::numbers::pi * (start_freq + point * freq_step) * delay;
+        double i = amplitude * std::cos(phase);
+        double q = amplitude * std::sin(phase);
+
+        if (data_format == SIM_FORMAT_ASCII) {
+            if (point != 0) {
+                values += ',';
+            }
+
+            append_number(values, i);
+            values += ',';
+            append_number(values, q);
+        } else {
+            append_binary(i);
+            append_binary(q);
+        }
+    }
+
+    if (data_format == SIM_FORMAT_ASCII) {
+        return values;
+    }
+
+    std::string length = std::to_string(values.size());
+
+    data += '#';
+    data += std::to_string(length.size());
+    data += length;
+    data += values;
+
+    return data;
+}
+
+/**
+ * \brief Выполнение команд настройки измерения, запуска измерения и чтения данных
+ *
+ * \param [in] header Заголовок команды
+ * \param [in] argument Аргументы команды
+ * \param [out] reply Ответ на запрос
+ *
+ * \return Если команда обработана - true. В противном случае - false.
+ */
+bool SimulatedVna::execute_specific(std::string_view header, std::string_view argument, std::string &reply) {
+    bool query = header.ends_with('?');
+    int trace_num = 1;
+
+    if (match(header, "[SENSe]:SWEep:POINts")) {
+        if (query) {
+            reply = std::to_string(points);
+        } else {
+            points = std::max(1, (int) parse_number(argument));
+        }
+    } else if (match(header, "[SENSe]:FREQuency:STARt")) {
+        if (query) {
+            append_number(reply, start_freq);
+        } else {
+            start_freq = parse_number(argument);
+        }
+    } else if (match(header, "[SENSe]:FREQuency:STOP")) {
+        if (query) {
+            append_number(reply, stop_freq);
+        } else {
+            stop_freq = parse_number(argument);
+        }
+    } else if (match(header, "[SENSe]:SWEep:TIME") && query) {
+        append_number(reply, config.sweep_time);
+    } else if (match(header, "FORMat:[DATA]")) {
+        if (query) {
+            reply = data_format == SIM_FORMAT_ASCII ? "ASC" : data_format == SIM_FORMAT_REAL32 ? "REAL,32" : "REAL,64";
+        } else {
+            std::string format = normalize(argument);
+
+            if (format.starts_with("ASC")) {
+                data_format = SIM_FORMAT_ASCII;
+            } else {
+                data_format = format.ends_with("32") ? SIM_FORMAT_REAL32 : SIM_FORMAT_REAL64;
+            }
+        }
+    } else if (match(header, "FORMat:BORDer")) {
+        if (query) {
+            reply = swapped_bytes ? "SWAP" : "NORM";
+        } else {
+            swapped_bytes = normalize(argument).starts_with("SWAP");
+        }
+    } else if (match(header, "CALCulate#:CUSTom:DEFine") || match(header, "CALCulate#:PARameter:DEFine")) {
+        define_trace(argument);
+    } else if (match(header, "CALCulate#:PARameter:DELete:ALL")) {
+        source_ports.clear();
+    } else if (match(header, "INITiate:[IMMediate]") || match(header, "TRIGger:[SEQuence]:SINGle")) {
+        start_operation(config.sweep_time * (double) std::max<size_t>(1, source_ports.size()));
+    } else if (match(header, "TRIGger:[SEQuence]:STATus") && query) {
+        reply = is_busy() ? "MEAS" : "HOLD";
+    } else if (match(header, "ABORt")) {
+        busy_until = std::chrono::steady_clock::now();
+    } else if (query && (match(header, "CALCulate:MEASure#:DATA:SDATA", &trace_num) ||
+            (model == SIM_VNA_PLANAR_S50244 && match(header, "CALCulate:TRACe#:DATA:SDATA", &trace_num)))) {
+        wait_operation();
+        reply = trace_data(trace_num);
+    } else {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс SimulatedVna
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_SIMULATED_VNA_HPP
+#define ANTESTL_BACKEND_SIMULATED_VNA_HPP
+
+#include "simulated_instrument.hpp"
+
+#include <set>
+
+/// Модель симулируемого ВАЦ: Keysight M9807A
+#define SIM_VNA_KEYSIGHT_M9807A     0x00
+/// Модель симулируемого ВАЦ: Planar S50244
+#define SIM_VNA_PLANAR_S50244       0x01
+
+/// Ответ на запрос *IDN? для Keysight M9807A
+#define SIM_IDN_KEYSIGHT_M9807A     "Keysight Technologies,M9807A,SIM0000001,A.15.00.00"
+/// Ответ на запрос *IDN? для Planar S50244
+#define SIM_IDN_PLANAR_S50244       "Planar,S50244,SIM0000001,24.1.0"
+
+/// Количество точек измерения по умолчанию
+#define SIM_VNA_DEFAULT_POINTS      201
+/// Начальная частота по умолчанию в Гц
+#define SIM_VNA_DEFAULT_START_FREQ  1e9
+/// Конечная частота по умолчанию в Гц
+#define SIM_VNA_DEFAULT_STOP_FREQ   2e9
+/// Групповая задержка, которая добавляется к данным каждой следующей трассы, в секундах
+#define SIM_VNA_TRACE_DELAY         1e-9
+
+/// Формат данных трасс: текст
+#define SIM_FORMAT_ASCII            0x00
+/// Формат данных трасс: двоичный блок 32-битных чисел
+#define SIM_FORMAT_REAL32           0x01
+/// Формат данных трасс: двоичный блок 64-битных чисел
+#define SIM_FORMAT_REAL64           0x02
+
+/**
+ * \brief Класс симулируемого векторного анализатора цепей
+ *
+ * Реализует подмножество команд SCPI, которое используют драйверы
+ * KeysightM9807A и PlanarS50244: настройку частот и количества точек, формат
+ * данных и порядок байт, запуск измерения (INITiate, TRIGger:SINGle), состояние
+ * триггера и чтение данных трасс. Как и реальный ВАЦ, симулятор выполняет отдельный
+ * проход для каждого зондирующего порта созданных трасс S-параметров, поэтому
+ * измерение длится simulator_config_t::sweep_time секунд на каждый такой порт.
+ * Данные трассы - отклик линии задержки, длина которой растёт с номером
+ * трассы.
+ */
+class SimulatedVna : public ScpiInstrument {
+    /// Модель ВАЦ SIM_VNA_*
+    int model;
+
+    /// Количество точек измерения
+    int points = SIM_VNA_DEFAULT_POINTS;
+    /// Начальная частота в Гц
+    double start_freq = SIM_VNA_DEFAULT_START_FREQ;
+    /// Конечная частота в Гц
+    double stop_freq = SIM_VNA_DEFAULT_STOP_FREQ;
+
+    /// Формат данных трасс SIM_FORMAT_*
+    int data_format = SIM_FORMAT_ASCII;
+    /// Флаг, показывающий, передаются ли числа младшим байтом вперёд
+    bool swapped_bytes = false;
+
+    /// Зондирующие порты созданных трасс S-параметров
+    std::set<int> source_ports{};
+
+    std::string trace_data(int trace_num) const;
+    void define_trace(std::string_view argument);
+
+protected:
+    bool execute_specific(std::string_view header, std::string_view argument, std::string &reply) override;
+    void reset() override;
+
+public:
+    SimulatedVna(const simulator_config_t &config, int model);
+};
+
+#endif //ANTESTL_BACKEND_SIMULATED_VNA_HPP
@@ -0,0 +1,176 @@
+/**
+ * \file
+ * \brief Главный файл симулятора приборов
+ *
+ * Симулятор запускает TCP-серверы, которые отвечают на команды SCPI так же, как
+ * ВАЦ Keysight M9807A и Planar S50244, генератор Keysight и оси ОПУ ТЕСАРТ.
+ * К серверам подключаются по адресам вида "TCPIP0::localhost::<порт>::SOCKET",
+ * что позволяет измерять производительность AntestL Backend без приборов.
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "scpi_server.hpp"
+#include "simulated_axis.hpp"
+#include "simulated_gen.hpp"
+#include "simulated_vna.hpp"
+#include "../utils/logger.hpp"
+
+/// Стандартный порт симулятора Keysight M9807A
+#define DEFAULT_KEYSIGHT_VNA_PORT   5025
+/// Стандартный порт симулятора Planar S50244
+#define DEFAULT_PLANAR_VNA_PORT     5026
+/// Стандартный порт симулятора генератора
+#define DEFAULT_GEN_PORT            5027
+/// Стандартный порт первой оси ОПУ (порты следующих осей идут подряд)
+#define DEFAULT_RBD_PORT            5030
+/// Стандартное количество осей ОПУ
+#define DEFAULT_AXES_COUNT          2
+
+/// Параметр изменения уровня логирования
+#define LOG_LEVEL_PARAM             "-log"
+/// Параметр изменения порта симулятора Keysight M9807A
+#define KEYSIGHT_VNA_PORT_PARAM     "-vna"
+/// Параметр изменения порта симулятора Planar S50244
+#define PLANAR_VNA_PORT_PARAM       "-planar"
+/// Параметр изменения порта симулятора генератора
+#define GEN_PORT_PARAM              "-gen"
+/// Параметр изменения порта первой оси ОПУ
+#define RBD_PORT_PARAM              "-rbd"
+/// Параметр изменения количества осей ОПУ
+#define AXES_COUNT_PARAM            "-axes"
+/// Параметр изменения длительности измерения ВАЦ
+#define SWEEP_TIME_PARAM            "-sweep"
+/// Параметр изменения времени установления
+#define SETTLE_TIME_PARAM           "-settle"
+/// Параметр изменения скорости вращения осей ОПУ
+#define VELOCITY_PARAM              "-velocity"
+
+/// Флаг, показывающий, что было нажато сочетание клавиш Ctrl+C
+volatile std::sig_atomic_t stop_simulator = false;
+
+/**
+ * \brief Обработчик нажатия Ctrl+C
+ *
+ * \param [in] signum Номер сигнала
+ */
+void exit_event_handler(int signum) {
+    stop_simulator = true;
+}
+
+void usage();
+
+int main(int argc, char *argv[]) {
+    std::signal(SIGINT, exit_event_handler);
+
+    logger::set_log_level(LEVEL_INFO);
+    logger::set_color_state(NO_COLOR);
+
+    simulator_config_t config{};
+
+    int keysight_vna_port = DEFAULT_KEYSIGHT_VNA_PORT;
+    int planar_vna_port = DEFAULT_PLANAR_VNA_PORT;
+    int gen_port = DEFAULT_GEN_PORT;
+    int rbd_port = DEFAULT_RBD_PORT;
+    int axes_count = DEFAULT_AXES_COUNT;
+
+    for (int arg_pos = 1; arg_pos < argc; ++arg_pos) {
+        if (arg_pos + 1 == argc) {
+            usage();
+            return 0;
+        }
+
+        const char *value = argv[arg_pos + 1];
+
+        if (strcmp(argv[arg_pos], LOG_LEVEL_PARAM) == 0) {
+            logger::set_log_level(atoi(value));
+        } else if (strcmp(argv[arg_pos], KEYSIGHT_VNA_PORT_PARAM) == 0) {
+            keysight_vna_port = atoi(value);
+        } else if (strcmp(argv[arg_pos], PLANAR_VNA_PORT_PARAM) == 0) {
+            planar_vna_port = atoi(value);
+        } else if (strcmp(argv[arg_pos], GEN_PORT_PARAM) == 0) {
+            gen_port = atoi(value);
+        } else if (strcmp(argv[arg_pos], RBD_PORT_PARAM) == 0) {
+            rbd_port = atoi(value);
+        } else if (strcmp(argv[arg_pos], AXES_COUNT_PARAM) == 0) {
+            axes_count = atoi(value);
+        } else if (strcmp(argv[arg_pos], SWEEP_TIME_PARAM) == 0) {
+            config.sweep_time = atof(value);
+        } else if (strcmp(argv[arg_pos], SETTLE_TIME_PARAM) == 0) {
+            config.settle_time = atof(value);
+        } else if (strcmp(argv[arg_pos], VELOCITY_PARAM) == 0) {
+            config.velocity = atof(value);
+        } else {
+            usage();
+            return 0;
+        }
+
+        ++arg_pos;
+    }
+
+    std::vector<std::unique_ptr<SimulatedInstrument>> instruments{};
+    std::vector<std::unique_ptr<ScpiServer>> servers{};
+
+    auto add_server = [&](std::unique_ptr<SimulatedInstrument> instrument, int port) {
+        if (port <= 0) {
+            return true;
+        }
+
+        servers.push_back(std::make_unique<ScpiServer>(*instrument, port));
+        instruments.push_back(std::move(instrument));
+
+        return servers.back()->start();
+    };
+
+    bool started = add_server(std::make_unique<SimulatedVna>(config, SIM_VNA_KEYSIGHT_M9807A), keysight_vna_port) &&
+            add_server(std::make_unique<SimulatedVna>(config, SIM_VNA_PLANAR_S50244), planar_vna_port) &&
+            add_server(std::make_unique<SimulatedGen>(config), gen_port);
+
+    for (int axis_num = 0; started && rbd_port > 0 && axis_num < axes_count; ++axis_num) {
+        started = add_server(std::make_unique<SimulatedAxis>(config), rbd_port + axis_num);
+    }
+
+    if (!started) {
+        return 1;
+    }
+
+    logger::log(LEVEL_INFO, "Simulator started (sweep time = {} s, settle time = {} s, velocity = {} deg/s)",
+                config.sweep_time, config.settle_time, config.velocity);
+
+    while (!stop_simulator) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SCPI_SERVER_POLL_INTERVAL));
+    }
+
+    logger::log(LEVEL_INFO, "Stopping simulator");
+
+    for (std::unique_ptr<ScpiServer> &server : servers) {
+        server->stop();
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Вывод справки по параметрам запуска
+ */
+void usage() {
+    std::cout << "\n===== AntestL Simulator =====\n" << std::endl;
+
+    std::cout << "Usage:" << std::endl;
+    std::cout << "-log      -- sets log level: 0 (error) .. 4 (trace), default: 2" << std::endl;
+    std::cout << "-vna      -- sets Keysight M9807A port, 0 disables (default: 5025)" << std::endl;
+    std::cout << "-planar   -- sets Planar S50244 port, 0 disables (default: 5026)" << std::endl;
+    std::cout << "-gen      -- sets Keysight generator port, 0 disables (default: 5027)" << std::endl;
+    std::cout << "-rbd      -- sets first positioner axis port, 0 disables (default: 5030)" << std::endl;
+    std::cout << "-axes     -- sets positioner axes count, one port per axis (default: 2)" << std::endl;
+    std::cout << "-sweep    -- sets VNA sweep time in seconds (default: 0.05)" << std::endl;
+    std::cout << "-settle   -- sets generator and axis settle time in seconds (default: 0.01)" << std::endl;
+    std::cout << "-velocity -- sets axis velocity in degrees per second (default: 50)" << std::endl;
+}
@@ -0,0 +1,564 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса ResultStore
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "result_store.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \brief Размер области записи, которую занимают углы осей ОПУ
+ *
+ * Размер выравнивается по 8 байт, чтобы массивы double внутри записи были выровнены.
+ *
+ * \param [in] axes_count Количество осей
+ *
+ * \return Размер области в байтах
+ */
+static uint64_t angles_size(uint64_t axes_count) {
+    return (axes_count * sizeof(float) + 7) & ~uint64_t(7);
+}
+
+/**
+ * \brief Деструктор, который закрывает хранилище
+ */
+ResultStore::~ResultStore() {
+    close();
+}
+
+/**
+ * \brief Указатель на заголовок отображённого файла
+ *
+ * \return Указатель на заголовок. Если файл не отображён, то возвращает nullptr.
+ */
+result_store_header_t *ResultStore::header() {
+    return reinterpret_cast<result_store_header_t *>(mapped_data);
+}
+
+/**
+ * \brief Указатель на заголовок отображённого файла
+ *
+ * \return Указатель на заголовок. Если файл не отображён, то возвращает nullptr.
+ */
+const result_store_header_t *ResultStore::header() const {
+    return reinterpret_cast<const result_store_header_t *>(mapped_data);
+}
+
+/**
+ * \brief Отображение файла хранилища в память
+ *
+ * Если хранилище открыто для записи, то файл расширяется до требуемого размера.
+ *
+ * \param [in] size Размер отображаемой области в байтах
+ *
+ * \return Если отображение выполнено успешно - true. В противном случае - false.
+ */
+bool ResultStore::map(uint64_t size) {
+#ifdef _WIN32
+    mapping_handle = CreateFileMappingA(
+            file_handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+            DWORD(size >> 32), DWORD(size & 0xFFFFFFFF), nullptr);
+
+    if (mapping_handle == nullptr) {
+        return false;
+    }
+
+    mapped_data = static_cast<char *>(MapViewOfFile(mapping_handle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size));
+
+    if (mapped_data == nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+
+        return false;
+    }
+#else
+    if (writable && ftruncate(file_descriptor, off_t(size)) != 0) {
+        return false;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, file_descriptor, 0);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    mapped_data = static_cast<char *>(data);
+#endif
+
+    mapped_size = size;
+    return true;
+}
+
+/**
+ * \brief Отмена отображения файла хранилища в память
+ */
+void ResultStore::unmap() {
+    if (mapped_data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    if (writable) {
+        FlushViewOfFile(mapped_data, 0);
+    }
+
+    UnmapViewOfFile(mapped_data);
+    CloseHandle(mapping_handle);
+
+    mapping_handle = nullptr;
+#else
+    if (writable) {
+        msync(mapped_data, mapped_size, MS_SYNC);
+    }
+
+    munmap(mapped_data, mapped_size);
+#endif
+
+    mapped_data = nullptr;
+    mapped_size = 0;
+}
+
+/**
+ * \brief Расширение файла хранилища так, чтобы в нём поместилось требуемое
+ * количество записей
+ *
+ * Файл расширяется как минимум в два раза, поэтому повторное отображение
+ * выполняется редко.
+ *
+ * \param [in] record_count Требуемое количество записей
+ *
+ * \return Если расширение выполнено успешно - true. В противном случае - false.
+ */
+bool ResultStore::reserve(uint64_t record_count) {
+    uint64_t record_size = header()->record_size;
+    uint64_t required_size = sizeof(result_store_header_t) + record_count * record_size;
+
+    if (required_size <= mapped_size) {
+        return true;
+    }
+
+    uint64_t capacity = (mapped_size - sizeof(result_store_header_t)) / record_size;
+    capacity = std::max({record_count, capacity * 2, (uint64_t) RESULT_STORE_MIN_RECORDS});
+
+    unmap();
+    return map(sizeof(result_store_header_t) + capacity * record_size);
+}
+
+/**
+ * \brief Создание нового хранилища результатов
+ *
+ * Путь к хранилищу передаёт клиент, поэтому существующие файлы не перезаписываются:
+ * если файл хранилища или его индекса уже существует, то хранилище не создаётся.
+ * Размер записей определяется при сохранении первой записи.
+ *
+ * \param [in] path Путь к файлу хранилища
+ *
+ * \return Если хранилище создано - true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * ResultStore store{};
+ *
+ * if (store.create("sweep.bin")) {
+ *     store.write(0, device_set.get_data({2, 4}));
+ *     store.close();
+ * }
+ * \endcode
+ */
+bool ResultStore::create(const std::string &path) {
+    close();
+
+    writable = true;
+    this->path = path;
+
+#ifdef _WIN32
+    file_handle = CreateFileA(
+            path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+    }
+
+    bool file_opened = file_handle != nullptr;
+#else
+    file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    bool file_opened = file_descriptor >= 0;
+#endif
+
+    if (!file_opened) {
+        logger::log(LEVEL_ERROR, "Can't create result store {} (file may already exist)", path);
+        return false;
+    }
+
+    // Режим "x" не позволяет открыть уже существующий файл индекса
+    std::string index_path = path + RESULT_STORE_INDEX_EXT;
+    std::FILE *index = std::fopen(index_path.c_str(), "wbx");
+
+    if (index != nullptr) {
+        std::fclose(index);
+        index_file.open(index_path, std::ios::in | std::ios::out | std::ios::binary);
+    }
+
+    if (!index_file.is_open()) {
+        logger::log(LEVEL_ERROR, "Can't create result store index {} (file may already exist)", index_path);
+
+        close();
+        std::remove(path.c_str());
+
+        return false;
+    }
+
+    created_at = std::chrono::steady_clock::now();
+
+    logger::log(LEVEL_DEBUG, "Result store {} created", path);
+    return true;
+}
+
+/**
+ * \brief Открытие существующего хранилища результатов для чтения
+ *
+ * Хранилище не открывается, если размер записи в заголовке не соответствует
+ * количеству осей, портов и частотных точек или если записи не умещаются в файле.
+ *
+ * \param [in] path Путь к файлу хранилища
+ *
+ * \return Если хранилище открыто - true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * ResultStore store{};
+ * data_t data{};
+ *
+ * if (store.open("sweep.bin") && store.read(0, data)) {
+ *     std::cout << data.to_string() << std::endl;
+ * }
+ * \endcode
+ */
+bool ResultStore::open(const std::string &path) {
+    close();
+
+    writable = false;
+    this->path = path;
+
+    uint64_t file_size = 0;
+
+#ifdef _WIN32
+    file_handle = CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+    }
+
+    LARGE_INTEGER size{};
+    if (file_handle != nullptr && GetFileSizeEx(file_handle, &size)) {
+        file_size = size.QuadPart;
+    }
+#else
+    file_descriptor = ::open(path.c_str(), O_RDONLY);
+
+    struct stat file_stat{};
+    if (file_descriptor >= 0 && fstat(file_descriptor, &file_stat) == 0) {
+        file_size = file_stat.st_size;
+    }
+#endif
+
+    if (file_size < sizeof(result_store_header_t) || !map(file_size)) {
+        logger::log(LEVEL_ERROR, "Can't open result store {}", path);
+
+        close();
+        return false;
+    }
+
+    if (std::memcmp(header()->magic, RESULT_STORE_MAGIC, sizeof(header()->magic)) != 0 ||
+        header()->version != RESULT_STORE_VERSION) {
+        logger::log(LEVEL_ERROR, "File {} is not a result store", path);
+
+        close();
+        return false;
+    }
+
+    // Размер записи и количество записей должны соответствовать размеру файла,
+    // иначе при чтении записей произойдёт выход за границы отображения
+    const result_store_header_t *file_header = header();
+    uint64_t angles = angles_size(file_header->axes_count);
+    uint64_t point_size = sizeof(double) * (1 + 2 * uint64_t(file_header->port_count));
+
+    bool valid = file_header->points != 0 && file_header->record_size > angles &&
+                 (file_header->record_size - angles) % point_size == 0 &&
+                 (file_header->record_size - angles) / point_size == file_header->points &&
+                 file_header->record_count <= (file_size - sizeof(result_store_header_t)) / file_header->record_size;
+
+    if (!valid) {
+        logger::log(LEVEL_ERROR, "Result store {} is damaged", path);
+
+        close();
+        return false;
+    }
+
+    index_file.open(path + RESULT_STORE_INDEX_EXT, std::ios::in | std::ios::binary);
+    return true;
+}
+
+/**
+ * \brief Закрытие хранилища
+ *
+ * Если хранилище было открыто для записи, то файл усекается до размера,
+ * занимаемого сохранёнными записями.
+ */
+void ResultStore::close() {
+    uint64_t file_size = 0;
+
+    if (writable && mapped_data != nullptr) {
+        file_size = sizeof(result_store_header_t) + header()->record_count * header()->record_size;
+    }
+
+    unmap();
+
+#ifdef _WIN32
+    if (file_handle != nullptr) {
+        if (file_size != 0) {
+            LARGE_INTEGER size{};
+            size.QuadPart = LONGLONG(file_size);
+
+            SetFilePointerEx(file_handle, size, nullptr, FILE_BEGIN);
+            SetEndOfFile(file_handle);
+        }
+
+        CloseHandle(file_handle);
+        file_handle = nullptr;
+    }
+#else
+    if (file_descriptor >= 0) {
+        if (file_size != 0 && ftruncate(file_descriptor, off_t(file_size)) != 0) {
+            logger::log(LEVEL_WARN, "Can't truncate result store {}", path);
+        }
+
+        ::close(file_descriptor);
+        file_descriptor = -1;
+    }
+#endif
+
+    if (index_file.is_open()) {
+        index_file.close();
+    }
+
+    writable = false;
+}
+
+/**
+ * \brief Метод, позволяющий проверить, открыто ли хранилище
+ *
+ * \return Если хранилище открыто - true. В противном случае - false.
+ */
+bool ResultStore::is_open() const {
+#ifdef _WIN32
+    return file_handle != nullptr;
+#else
+    return file_descriptor >= 0;
+#endif
+}
+
+/**
+ * \brief Сохранение результата одного вызова get_data() в хранилище
+ *
+ * Записи могут сохраняться в произвольном порядке: номер записи определяет её
+ * положение в файле. Все записи должны иметь одинаковое количество осей, портов
+ * и частотных точек.
+ *
+ * \param [in] record_index Номер записи
+ * \param [in] data Данные, полученные при измерении
+ *
+ * \return Если запись сохранена - true. В противном случае - false.
+ */
+bool ResultStore::write(uint64_t record_index, const data_t &data) {
+    if (!writable || !is_open() || data.freq_list.empty()) {
+        return false;
+    }
+
+    uint64_t points = data.points();
+
+    if (mapped_data == nullptr) {
+        uint64_t record_size =
+                angles_size(data.angle_list.size()) +
+                points * sizeof(double) * (1 + 2 * data.port_data_list.size());
+
+        if (!map(sizeof(result_store_header_t) + RESULT_STORE_MIN_RECORDS * record_size)) {
+            logger::log(LEVEL_ERROR, "Can't map result store {}", path);
+            return false;
+        }
+
+        std::memcpy(header()->magic, RESULT_STORE_MAGIC, sizeof(header()->magic));
+        header()->version = RESULT_STORE_VERSION;
+        header()->axes_count = data.angle_list.size();
+        header()->port_count = data.port_data_list.size();
+        header()->points = points;
+        header()->record_size = record_size;
+        header()->record_count = 0;
+    }
+
+    if (header()->axes_count != data.angle_list.size() ||
+        header()->port_count != data.port_data_list.size() ||
+        header()->points != points) {
+        logger::log(LEVEL_ERROR, "Data layout doesn't match result store {}", path);
+        return false;
+    }
+
+    if (!reserve(record_index + 1)) {
+        logger::log(LEVEL_ERROR, "Can't extend result store {}", path);
+        return false;
+    }
+
+    uint64_t offset = sizeof(result_store_header_t) + record_index * header()->record_size;
+    char *record = mapped_data + offset;
+
+    std::memcpy(record, data.angle_list.data(), data.angle_list.size() * sizeof(float));
+    record += angles_size(data.angle_list.size());
+
+    auto *freq = reinterpret_cast<double *>(record);
+
+    if (data.freq_list.size() >= points) {
+        std::memcpy(freq, data.freq_list.data(), points * sizeof(double));
+    } else {
+        std::fill(freq, freq + points, data.freq_list[0]);
+    }
+
+    record += points * sizeof(double);
+
+    for (const iq_port_data_t &port_data : data.port_data_list) {
+        std::memcpy(record, port_data.i.data(), points * sizeof(double));
+        record += points * sizeof(double);
+
+        std::memcpy(record, port_data.q.data(), points * sizeof(double));
+        record += points * sizeof(double);
+    }
+
+    header()->record_count = std::max(header()->record_count, record_index + 1);
+
+    result_store_index_t index_item{};
+    index_item.offset = offset;
+    index_item.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - created_at).count();
+    index_item.written = 1;
+
+    index_file.seekp(std::streamoff(record_index * sizeof(result_store_index_t)));
+    index_file.write(reinterpret_cast<const char *>(&index_item), sizeof(index_item));
+    index_file.flush();
+
+    return true;
+}
+
+/**
+ * \brief Чтение записи из хранилища
+ *
+ * \param [in] record_index Номер записи
+ * \param [out] data Структура, в которую записываются данные
+ *
+ * \return Если запись была прочитана - true. Если запись отсутствует или не была
+ * сохранена - false.
+ */
+bool ResultStore::read(uint64_t record_index, data_t &data) const {
+    if (mapped_data == nullptr || record_index >= header()->record_count) {
+        return false;
+    }
+
+    if (index_file.is_open()) {
+        result_store_index_t index_item{};
+
+        index_file.clear();
+        index_file.seekg(std::streamoff(record_index * sizeof(result_store_index_t)));
+        index_file.read(reinterpret_cast<char *>(&index_item), sizeof(index_item));
+
+        if (!index_file || index_item.written == 0) {
+            return false;
+        }
+    }
+
+    uint64_t points = header()->points;
+    const char *record = mapped_data + sizeof(result_store_header_t) + record_index * header()->record_size;
+
+    data.angle_list.resize(header()->axes_count);
+    std::memcpy(data.angle_list.data(), record, header()->axes_count * sizeof(float));
+    record += angles_size(header()->axes_count);
+
+    data.freq_list.resize(points);
+    std::memcpy(data.freq_list.data(), record, points * sizeof(double));
+    record += points * sizeof(double);
+
+    data.port_data_list.resize(header()->port_count);
+
+    for (iq_port_data_t &port_data : data.port_data_list) {
+        port_data.i.resize(points);
+        std::memcpy(port_data.i.data(), record, points * sizeof(double));
+        record += points * sizeof(double);
+
+        port_data.q.resize(points);
+        std::memcpy(port_data.q.data(), record, points * sizeof(double));
+        record += points * sizeof(double);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Запрос количества записей в хранилище
+ *
+ * \return Количество записей
+ */
+uint64_t ResultStore::get_record_count() const {
+    return mapped_data == nullptr ? 0 : header()->record_count;
+}
+
+/**
+ * \brief Запрос количества частотных точек в записи
+ *
+ * \return Количество точек
+ */
+uint32_t ResultStore::get_points() const {
+    return mapped_data == nullptr ? 0 : header()->points;
+}
+
+/**
+ * \brief Запрос количества портов ВАЦ в записи
+ *
+ * \return Количество портов
+ */
+uint32_t ResultStore::get_port_count() const {
+    return mapped_data == nullptr ? 0 : header()->port_count;
+}
+
+/**
+ * \brief Запрос количества осей ОПУ в записи
+ *
+ * \return Количество осей
+ */
+uint32_t ResultStore::get_axes_count() const {
+    return mapped_data == nullptr ? 0 : header()->axes_count;
+}
+
+/**
+ * \brief Запрос пути к файлу хранилища
+ *
+ * \return Путь к файлу
+ */
+const std::string &ResultStore::get_path() const {
+    return path;
+}
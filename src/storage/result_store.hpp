@@ -0,0 +1,134 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс ResultStore и набор
+ * констант для работы с ним
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_RESULT_STORE_HPP
+#define ANTESTL_BACKEND_RESULT_STORE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "../devices/device_set.hpp"
+
+/// Сигнатура файла хранилища результатов
+#define RESULT_STORE_MAGIC          "ANTSTORE"
+/// Версия формата файла хранилища результатов
+#define RESULT_STORE_VERSION        1
+/// Расширение файла индекса хранилища результатов
+#define RESULT_STORE_INDEX_EXT      ".idx"
+/// Минимальное количество записей, под которое расширяется файл хранилища
+#define RESULT_STORE_MIN_RECORDS    64
+
+/**
+ * \brief Заголовок файла хранилища результатов
+ *
+ * Все записи файла имеют одинаковый размер record_size, поэтому запись с номером n
+ * начинается со смещения sizeof(result_store_header_t) + n * record_size.
+ */
+struct result_store_header_t {
+    /// Сигнатура файла
+    char magic[8];
+    /// Версия формата
+    uint32_t version;
+    /// Количество осей ОПУ
+    uint32_t axes_count;
+    /// Количество портов ВАЦ
+    uint32_t port_count;
+    /// Количество частотных точек в записи
+    uint32_t points;
+    /// Размер одной записи в байтах
+    uint64_t record_size;
+    /// Количество записей
+    uint64_t record_count;
+    /// Резерв
+    uint64_t reserved[3];
+};
+
+/**
+ * \brief Элемент файла индекса хранилища результатов
+ *
+ * Индекс содержит по одному элементу на каждую запись и позволяет определить,
+ * какие записи были сохранены (например, если измерение было прервано).
+ */
+struct result_store_index_t {
+    /// Смещение записи в файле хранилища
+    uint64_t offset;
+    /// Время сохранения записи в микросекундах с момента создания хранилища
+    int64_t timestamp_us;
+    /// Флаг, показывающий, была ли сохранена запись
+    uint32_t written;
+    /// Резерв
+    uint32_t reserved;
+};
+
+/**
+ * \brief Класс хранилища результатов измерений
+ *
+ * Результат каждого вызова get_data() сохраняется в отображённый в память файл в
+ * виде записи фиксированного размера. Внутри записи данные хранятся по столбцам:
+ * углы осей ОПУ (float), частоты (double), синфазные и квадратурные составляющие
+ * каждого порта (double). Рядом с файлом создаётся файл индекса.
+ */
+class ResultStore {
+    /// Путь к файлу хранилища
+    std::string path{};
+    /// Флаг, показывающий, открыто ли хранилище для записи
+    bool writable = false;
+
+    /// Дескриптор файла хранилища
+    void *file_handle = nullptr;
+    /// Дескриптор отображения файла (используется в Windows)
+    void *mapping_handle = nullptr;
+    /// Файловый дескриптор (используется в POSIX)
+    int file_descriptor = -1;
+
+    /// Указатель на начало отображённого файла
+    char *mapped_data = nullptr;
+    /// Размер отображённой области в байтах
+    uint64_t mapped_size = 0;
+
+    /// Файл индекса
+    mutable std::fstream index_file{};
+    /// Время создания хранилища
+    std::chrono::steady_clock::time_point created_at{};
+
+    result_store_header_t *header();
+    const result_store_header_t *header() const;
+
+    bool map(uint64_t size);
+    void unmap();
+
+    bool reserve(uint64_t record_count);
+
+public:
+    ResultStore() = default;
+    ~ResultStore();
+
+    ResultStore(const ResultStore &) = delete;
+    ResultStore &operator=(const ResultStore &) = delete;
+
+    bool create(const std::string &path);
+    bool open(const std::string &path);
+    void close();
+
+    bool is_open() const;
+
+    bool write(uint64_t record_index, const data_t &data);
+    bool read(uint64_t record_index, data_t &data) const;
+
+    uint64_t get_record_count() const;
+    uint32_t get_points() const;
+    uint32_t get_port_count() const;
+    uint32_t get_axes_count() const;
+
+    const std::string &get_path() const;
+};
+
+#endif //ANTESTL_BACKEND_RESULT_STORE_HPP
@@ -0,0 +1,318 @@
+/**
+ * \file
+ * \brief Файл исходного кода, в котором реализованы методы для класса TouchstoneWriter
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#include "touchstone_writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * \brief Деструктор, который закрывает все файлы
+ */
+TouchstoneWriter::~TouchstoneWriter() {
+    close();
+}
+
+/**
+ * \brief Открытие набора файлов Touchstone
+ *
+ * Файлы создаются при первой записи в группу. Имя файла формируется из базового
+ * пути, имени группы и расширения ".sNp", где N - количество портов. Например,
+ * для базового пути "D:/sweep", группы "-30.000" и 8 портов будет создан файл
+ * "D:/sweep_-30.000.s8p".
+ *
+ * \param [in] base_path Путь к файлам без расширения
+ * \param [in] port_count Количество портов ВАЦ
+ * \param [in] meas_type Тип измерения
+ * \param [in] source_port Номер зондирующего порта
+ *
+ * \return Если параметры корректны - true. В противном случае - false.
+ *
+ * **Пример**
+ * \code
+ * TouchstoneWriter writer{};
+ *
+ * if (writer.open("D:/sweep", 2, MEAS_TRANSITION, 1)) {
+ *     writer.write("", {1, 2}, device_set.get_data({1, 2}));     // Будет создан файл "D:/sweep.s2p"
+ *     writer.close();
+ * }
+ * \endcode
+ */
+bool TouchstoneWriter::open(const std::string &base_path, int port_count, int meas_type, int source_port) {
+    close();
+
+    if (base_path.empty() || port_count <= 0) {
+        logger::log(LEVEL_ERROR, "Wrong touchstone parameters: path = \"{}\", ports = {}", base_path, port_count);
+        return false;
+    }
+
+    this->base_path = base_path;
+    this->port_count = port_count;
+    this->meas_type = meas_type;
+    this->source_port = source_port;
+
+    s_re.assign(port_count * port_count, 0.0);
+    s_im.assign(port_count * port_count, 0.0);
+
+    opened = true;
+
+    logger::log(LEVEL_DEBUG, "Touchstone writer opened: {}, {} ports", base_path, port_count);
+    return true;
+}
+
+/**
+ * \brief Закрытие всех файлов набора
+ */
+void TouchstoneWriter::close() {
+    for (auto &[group, file] : files) {
+        if (file.stream != nullptr) {
+            file.stream->close();
+        }
+    }
+
+    files.clear();
+    open_file_count = 0;
+    use_counter = 0;
+
+    opened = false;
+}
+
+/**
+ * \brief Метод, позволяющий проверить, открыт ли набор файлов
+ *
+ * \return Если набор файлов открыт - true. В противном случае - false.
+ */
+bool TouchstoneWriter::is_open() const {
+    return opened;
+}
+
+/**
+ * \brief Закрытие файла, к которому дольше всего не было обращений
+ */
+void TouchstoneWriter::close_least_used() {
+    touchstone_file_t *least_used = nullptr;
+
+    for (auto &[group, file] : files) {
+        if (file.stream != nullptr && (least_used == nullptr || file.last_use < least_used->last_use)) {
+            least_used = &file;
+        }
+    }
+
+    if (least_used != nullptr) {
+        least_used->stream->close();
+        least_used->stream.reset();
+
+        --open_file_count;
+    }
+}
+
+/**
+ * \brief Получение потока записи для файла группы
+ *
+ * Если файл группы ещё не создан, то он создаётся и в него записывается заголовок.
+ * Существующий файл с тем же именем не перезаписывается: в этом случае возвращается
+ * nullptr. Если файл был закрыт из-за ограничения количества открытых файлов, то он
+ * открывается для дописывания.
+ *
+ * \param [in] group Имя группы
+ *
+ * \return Указатель на поток записи. Если файл не удалось открыть - nullptr.
+ */
+std::ofstream *TouchstoneWriter::get_stream(const std::string &group) {
+    auto [item, created] = files.try_emplace(group);
+    touchstone_file_t &file = item->second;
+
+    file.last_use = ++use_counter;
+
+    if (file.stream != nullptr) {
+        return file.stream.get();
+    }
+
+    if (open_file_count >= TOUCHSTONE_MAX_OPEN_FILES) {
+        close_least_used();
+    }
+
+    if (created) {
+        file.path = std::format("{}{}{}.s{}p", base_path, group.empty() ? "" : "_", group, port_count);
+    }
+
+    // Новый файл создаётся только в том случае, если файла с таким именем ещё нет,
+    // чтобы не перезаписать результаты предыдущих измерений
+    if (created) {
+        std::FILE *new_file = std::fopen(file.path.c_str(), "wbx");
+
+        if (new_file == nullptr) {
+            logger::log(LEVEL_ERROR, "Can't create touchstone file {}. File may already exist", file.path);
+
+            files.erase(item);
+            return nullptr;
+        }
+
+        std::fclose(new_file);
+    }
+
+    file.stream = std::make_unique<std::ofstream>(file.path, std::ios::binary | std::ios::app);
+
+    if (!file.stream->is_open()) {
+        logger::log(LEVEL_ERROR, "Can't open touchstone file {}", file.path);
+
+        file.stream.reset();
+        return nullptr;
+    }
+
+    ++open_file_count;
+
+    if (created) {
+        *file.stream
+                << TOUCHSTONE_COMMENT << " AntestL Backend\n"
+                << TOUCHSTONE_COMMENT << " Group: " << (group.empty() ? "-" : group) << '\n'
+                << TOUCHSTONE_COMMENT << " Measurement: "
+                << (meas_type == MEAS_TRANSITION ? std::format("transmission, source port {}", source_port) : "reflection")
+                << '\n'
+                << TOUCHSTONE_OPTION_LINE << '\n';
+    }
+
+    return file.stream.get();
+}
+
+/**
+ * \brief Добавление числа в конец буфера строки
+ *
+ * \param [in] value Значение
+ * \param [in] format Формат записи числа
+ * \param [in] precision Количество знаков после запятой
+ */
+void TouchstoneWriter::append_number(double value, std::chars_format format, int precision) {
+    char buffer[FIXED_NUMBER_MAX_SIZE + SCIENTIFIC_NUMBER_EXTRA_SIZE + MAX_DATA_PRECISION];
+
+    auto [ptr, error] = std::to_chars(buffer, buffer + sizeof(buffer), value, format, precision);
+
+    if (!line.empty() && line.back() != '\n') {
+        line += ' ';
+    }
+
+    line.append(buffer, ptr);
+}
+
+/**
+ * \brief Добавление части строки матрицы S-параметров в конец буфера строки
+ *
+ * \param [in] row Номер строки матрицы
+ * \param [in] first_column Номер первого столбца
+ * \param [in] last_column Номер столбца, следующего за последним
+ */
+void TouchstoneWriter::append_matrix_row(int row, int first_column, int last_column) {
+    for (int column = first_column; column < last_column; ++column) {
+        append_number(s_re[row * port_count + column], std::chars_format::scientific, TOUCHSTONE_PRECISION);
+        append_number(s_im[row * port_count + column], std::chars_format::scientific, TOUCHSTONE_PRECISION);
+    }
+}
+
+/**
+ * \brief Запись результата одного измерения в файл группы
+ *
+ * Для каждой частотной точки формируется матрица S-параметров: при измерении
+ * коэффициента передачи данные порта p записываются в элемент S(p, source_port),
+ * при измерении коэффициента отражения - в элемент S(p, p). Строки матрицы
+ * записываются в порядке, установленном форматом Touchstone 1.1: для двух портов
+ * все значения записываются в одну строку в порядке S11, S21, S12, S22, для
+ * большего количества портов каждая строка матрицы начинается с новой строки
+ * файла и содержит не более TOUCHSTONE_PAIRS_PER_LINE пар значений.
+ *
+ * \param [in] group Имя группы (например, угловое положение ОПУ)
+ * \param [in] port_list Список портов, для которых проводилось измерение
+ * \param [in] data Данные, полученные при измерении
+ *
+ * \return Если данные записаны - true. В противном случае - false.
+ */
+bool TouchstoneWriter::write(const std::string &group, const std::vector<int> &port_list, const data_t &data) {
+    size_t points = data.points();
+
+    if (!opened || points == 0 || data.freq_list.empty()) {
+        return false;
+    }
+
+    std::ofstream *stream = get_stream(group);
+
+    if (stream == nullptr) {
+        return false;
+    }
+
+    touchstone_file_t &file = files[group];
+
+    for (size_t pos = 0; pos < points; ++pos) {
+        double freq = data.freq_list.size() > 1 ? data.freq_list[pos] : data.freq_list[0];
+
+        if (freq <= file.last_freq && file.ordered) {
+            logger::log(LEVEL_WARN, "Frequencies in touchstone file {} are not increasing", file.path);
+            file.ordered = false;
+        }
+
+        file.last_freq = freq;
+
+        std::fill(s_re.begin(), s_re.end(), 0.0);
+        std::fill(s_im.begin(), s_im.end(), 0.0);
+
+        for (size_t port_pos = 0; port_pos < port_list.size() && port_pos < data.port_data_list.size(); ++port_pos) {
+            int row = port_list[port_pos] - 1;
+            int column = meas_type == MEAS_TRANSITION ? source_port - 1 : row;
+
+            if (row < 0 || row >= port_count || column < 0 || column >= port_count) {
+                continue;
+            }
+
+            s_re[row * port_count + column] = data.port_data_list[port_pos].i[pos];
+            s_im[row * port_count + column] = data.port_data_list[port_pos].q[pos];
+        }
+
+        line.clear();
+        append_number(freq, std::chars_format::fixed, 0);
+
+        if (port_count == 2) {
+            append_matrix_row(0, 0, 1);
+            append_matrix_row(1, 0, 1);
+            append_matrix_row(0, 1, 2);
+            append_matrix_row(1, 1, 2);
+        } else {
+            for (int row = 0; row < port_count; ++row) {
+                for (int column = 0; column < port_count; column += TOUCHSTONE_PAIRS_PER_LINE) {
+                    if (row != 0 || column != 0) {
+                        line += "\n";
+                    }
+
+                    append_matrix_row(row, column, std::min(column + TOUCHSTONE_PAIRS_PER_LINE, port_count));
+                }
+            }
+        }
+
+        line += '\n';
+        stream->write(line.data(), (std::streamsize) line.size());
+    }
+
+    if (!stream->good()) {
+        logger::log(LEVEL_ERROR, "Can't write touchstone file {}", file.path);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Запрос списка созданных файлов
+ *
+ * \return Пути к файлам
+ */
+std::vector<std::string> TouchstoneWriter::get_file_list() const {
+    std::vector<std::string> file_list{};
+
+    for (const auto &[group, file] : files) {
+        file_list.push_back(file.path);
+    }
+
+    return file_list;
+}
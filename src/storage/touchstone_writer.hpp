@@ -0,0 +1,113 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определён класс TouchstoneWriter и набор
+ * констант для работы с ним
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_TOUCHSTONE_WRITER_HPP
+#define ANTESTL_BACKEND_TOUCHSTONE_WRITER_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../devices/device_set.hpp"
+
+/// Строка параметров файла Touchstone: частота в Гц, S-параметры в формате RI, сопротивление 50 Ом
+#define TOUCHSTONE_OPTION_LINE      "# Hz S RI R 50"
+/// Символ, с которого начинается комментарий в файле Touchstone
+#define TOUCHSTONE_COMMENT          '!'
+/// Максимальное количество пар значений в одной строке файла Touchstone
+#define TOUCHSTONE_PAIRS_PER_LINE   4
+/// Максимальное количество одновременно открытых файлов
+#define TOUCHSTONE_MAX_OPEN_FILES   32
+/// Количество знаков после запятой для значений S-параметров
+#define TOUCHSTONE_PRECISION        DEFAULT_DATA_PRECISION
+
+/**
+ * \brief Класс, позволяющий записывать результаты измерений в файлы Touchstone
+ * (.sNp) по мере их получения
+ *
+ * Строки данных дописываются в конец файла сразу после измерения, поэтому в памяти
+ * хранится только буфер одной строки. Результаты разделяются по группам (например,
+ * по угловым положениям ОПУ или по положениям переключателей): для каждой группы
+ * создаётся отдельный файл. Количество одновременно открытых файлов ограничено
+ * значением TOUCHSTONE_MAX_OPEN_FILES, остальные файлы переоткрываются по мере
+ * необходимости.
+ *
+ * Значения S-параметров, которые не измерялись, записываются как 0.
+ */
+class TouchstoneWriter {
+    /**
+     * \brief Структура, описывающая файл одной группы
+     */
+    struct touchstone_file_t {
+        /// Путь к файлу
+        std::string path{};
+        /// Поток записи. Если файл закрыт, то nullptr.
+        std::unique_ptr<std::ofstream> stream{};
+        /// Номер последнего обращения к файлу
+        uint64_t last_use = 0;
+        /// Последняя записанная частота
+        double last_freq = -1.0;
+        /// Флаг, показывающий, что частоты в файле записаны по возрастанию
+        bool ordered = true;
+    };
+
+    /// Путь к файлам без расширения
+    std::string base_path{};
+    /// Количество портов ВАЦ
+    int port_count = 0;
+    /// Тип измерения
+    int meas_type = MEAS_TRANSITION;
+    /// Номер зондирующего порта
+    int source_port = DEFAULT_VNA_SOURCE_PORT;
+
+    /// Флаг, показывающий, открыт ли набор файлов
+    bool opened = false;
+
+    /// Файлы, соответствующие группам
+    std::map<std::string, touchstone_file_t> files{};
+    /// Количество открытых файлов
+    int open_file_count = 0;
+    /// Счётчик обращений к файлам
+    uint64_t use_counter = 0;
+
+    /// Буфер, в котором формируются строки файла
+    std::string line{};
+    /// Действительные части матрицы S-параметров одной частотной точки
+    std::vector<double> s_re{};
+    /// Мнимые части матрицы S-параметров одной частотной точки
+    std::vector<double> s_im{};
+
+    std::ofstream *get_stream(const std::string &group);
+    void close_least_used();
+
+    void append_number(double value, std::chars_format format, int precision);
+    void append_matrix_row(int row, int first_column, int last_column);
+
+public:
+    TouchstoneWriter() = default;
+    ~TouchstoneWriter();
+
+    TouchstoneWriter(const TouchstoneWriter &) = delete;
+    TouchstoneWriter &operator=(const TouchstoneWriter &) = delete;
+
+    bool open(const std::string &base_path, int port_count, int meas_type, int source_port);
+    void close();
+
+    bool is_open() const;
+
+    bool write(const std::string &group, const std::vector<int> &port_list, const data_t &data);
+
+    std::vector<std::string> get_file_list() const;
+};
+
+#endif //ANTESTL_BACKEND_TOUCHSTONE_WRITER_HPP
@@ -7,7 +7,10 @@
  */
 
 #include "task_manager.hpp"
+#include <limits>
+#include <map>
 #include "utils/array_utils.hpp"
+#include "utils/string_utils.hpp"
 
 /**
  * \brief Метод, обрабатывающий задание на подключение
@@ -26,33 +29,43 @@ json TaskManager::connect_task(nlohmann::json device_list) {
     };
     json device_results;
 
+    std::vector<connect_request_t> request_list{};
+
     for (const auto &json_item : device_list.items()) {
         const std::string &device = json_item.key();
+        int device_type = DEVICE_VNA;
 
         if (device == DEVICE_EXT_GEN) {
-            device_results[json_item.key()] = device_set.connect(DEVICE_GEN, device, json_item.value());
-
-            if (!device_results[json_item.key()]) {
-                output[WORD_RESULT_ID] = EXT_GEN_NO_CONNECTION_ID;
-                output[WORD_RESULT_MSG] = EXT_GEN_NO_CONNECTION_MSG;
-                break;
-            }
+            device_type = DEVICE_GEN;
         } else if (device == DEVICE_RBD_UPKB || device == DEVICE_RBD_TESART || device == DEVICE_RBD_DEMO) {
-            device_results[json_item.key()] = device_set.connect(DEVICE_RBD, device, json_item.value());
+            device_type = DEVICE_RBD;
+        }
 
-            if (!device_results[json_item.key()]) {
-                output[WORD_RESULT_ID] = RBD_NO_CONNECTION_ID;
-                output[WORD_RESULT_MSG] = RBD_NO_CONNECTION_MSG;
-                break;
-            }
-        } else {
-            device_results[json_item.key()] = device_set.connect(DEVICE_VNA, device, json_item.value());
+        request_list.push_back({device_type, device, json_item.value().get<std::string>()});
+    }
 
-            if (!device_results[json_item.key()]) {
-                output[WORD_RESULT_ID] = VNA_NO_CONNECTION_ID;
-                output[WORD_RESULT_MSG] = VNA_NO_CONNECTION_MSG;
-                break;
-            }
+    std::vector<bool> connected = device_set.connect(request_list);
+    bool failed = false;
+
+    for (size_t pos = 0; pos < request_list.size(); ++pos) {
+        const connect_request_t &request = request_list[pos];
+        device_results[request.device_model] = (bool) connected[pos];
+
+        if (connected[pos] || failed) {
+            continue;
+        }
+
+        failed = true;
+
+        if (request.device_type == DEVICE_GEN) {
+            output[WORD_RESULT_ID] = EXT_GEN_NO_CONNECTION_ID;
+            output[WORD_RESULT_MSG] = EXT_GEN_NO_CONNECTION_MSG;
+        } else if (request.device_type == DEVICE_RBD) {
+            output[WORD_RESULT_ID] = RBD_NO_CONNECTION_ID;
+            output[WORD_RESULT_MSG] = RBD_NO_CONNECTION_MSG;
+        } else {
+            output[WORD_RESULT_ID] = VNA_NO_CONNECTION_ID;
+            output[WORD_RESULT_MSG] = VNA_NO_CONNECTION_MSG;
         }
     }
 
@@ -93,13 +106,71 @@ bool TaskManager::configure_task(json config_params) {
     if (config_params.contains("external")) {
         external = config_params["external"].get<bool>();
     }
+
+    int gen_sweep_mode = GEN_SWEEP_STEP;
+    if (config_params.contains("gen_sweep_mode")) {
+        gen_sweep_mode = config_params["gen_sweep_mode"].get<int>();
+    }
+
+    if (gen_sweep_mode < GEN_SWEEP_STEP || gen_sweep_mode > GEN_SWEEP_LIST_VNA) {
+        logger::log(LEVEL_ERROR, "Unknown external gen sweep mode = {}", gen_sweep_mode);
+        return false;
+    }
+
+    int data_format = DATA_FORMAT_ASCII;
+    if (config_params.contains("data_format")) {
+        data_format = config_params["data_format"].get<int>();
+    }
+
+    bool swapped_bytes = true;
+    if (config_params.contains("swapped_bytes")) {
+        swapped_bytes = config_params["swapped_bytes"].get<bool>();
+    }
+
+    int completion = COMPLETION_OPC_QUERY;
+    if (config_params.contains("completion")) {
+        completion = config_params["completion"].get<int>();
+    }
+
+    bool deferred_errors = false;
+    if (config_params.contains("deferred_errors")) {
+        deferred_errors = config_params["deferred_errors"].get<bool>();
+    }
+
+    std::map<int, int> timeouts{};
+    if (config_params.contains("timeouts")) {
+        const json &timeout_params = config_params["timeouts"];
+        const std::map<std::string, int> timeout_classes = {
+                {"query", TIMEOUT_QUERY},
+                {"config", TIMEOUT_CONFIG},
+                {"sweep", TIMEOUT_SWEEP},
+                {"motion", TIMEOUT_MOTION}
+        };
+
+        for (const auto &[name, timeout_class] : timeout_classes) {
+            if (timeout_params.contains(name)) {
+                timeouts[timeout_class] = timeout_params[name].get<int>();
+            }
+        }
+    }
     
     logger::log(
             LEVEL_DEBUG, 
-            R"(Configuring VNA with parameters: "meas_type" = {}; "rbw" = {}; "source_port" = {}; "external" = {})",
-            meas_type, rbw, source_port, external);
+            R"(Configuring VNA with parameters: "meas_type" = {}; "rbw" = {}; "source_port" = {}; "external" = {}; "gen_sweep_mode" = {}; "data_format" = {}; "swapped_bytes" = {}; "completion" = {}; "deferred_errors" = {})",
+            meas_type, rbw, source_port, external, gen_sweep_mode, data_format, swapped_bytes, completion,
+            deferred_errors);
+
+    bool result = true;
+
+    for (const auto &[timeout_class, timeout] : timeouts) {
+        result = result && device_set.set_timeout(timeout_class, timeout);
+    }
+
+    result = result && device_set.set_completion_mode(completion);
+    result = result && device_set.set_deferred_errors(deferred_errors);
+    result = result && device_set.configure(meas_type, rbw, source_port, external, gen_sweep_mode);
+    result = result && device_set.set_data_format(data_format, swapped_bytes);
 
-    bool result = device_set.configure(meas_type, rbw, source_port, external);
     return result;
 }
 
@@ -259,26 +330,309 @@ bool TaskManager::set_path_task(json path_values) {
 
     logger::log(LEVEL_DEBUG, data);
 
+    std::vector<std::string> path_names{};
+    for (int path : paths) {
+        path_names.push_back(std::to_string(path));
+    }
+
     bool result = device_set.set_path(std::move(paths));
+
+    if (result) {
+        current_path = string_utils::join(path_names, '-');
+    }
+
     return result;
 }
 
+/**
+ * \brief Метод, проводящий измерение и обработку полученных данных по аргументам
+ * задания "get_data"
+ *
+ * Если задан аргумент "average", то измерение повторяется указанное количество
+ * раз и квадратуры усредняются. Затем, если задан аргумент "decimate", остаётся
+ * каждая k-я точка трассы, а если задан аргумент "points_subset" - только точки
+ * с перечисленными индексами.
+ *
+ * Данные записываются в буфер acquisition_buffer, который используется повторно
+ * для всех точек измерения, поэтому при измерении точек одинакового размера
+ * память выделяется только для первой точки. Буфер освобождается после
+ * завершения списка заданий (см. release_acquisition_buffers()).
+ *
+ * \param [in] get_data_args JSON объект аргументов задания "get_data"
+ *
+ * \return Если измерение и обработка выполнены успешно - true. В противном случае -
+ * false, а буфер не содержит точек.
+ */
+bool TaskManager::acquire_data(const json &get_data_args) {
+    acquisition_ports.clear();
+
+    for (const json &port : get_data_args["ports"]) {
+        acquisition_ports.push_back(port.get<int>());
+    }
+
+    int average = 1;
+    if (get_data_args.contains("average")) {
+        average = std::max(get_data_args["average"].get<int>(), 1);
+    }
+
+    if (!device_set.get_averaged_data(acquisition_ports, average, acquisition_buffer)) {
+        return false;
+    }
+
+    bool decimate = get_data_args.contains("decimate");
+    bool subset = get_data_args.contains("points_subset");
+
+    if (!decimate && !subset) {
+        return true;
+    }
+
+    size_t points = acquisition_buffer.points();
+    point_indices.clear();
+
+    if (decimate) {
+        size_t step = std::max(get_data_args["decimate"].get<int>(), 1);
+
+        for (size_t pos = 0; pos < points; pos += step) {
+            point_indices.push_back(pos);
+        }
+    }
+
+    if (subset) {
+        size_t decimated_points = point_indices.size();
+
+        for (const json &index : get_data_args["points_subset"]) {
+            size_t pos = index.get<size_t>();
+
+            if (decimate) {
+                pos = pos < decimated_points ? point_indices[pos] : points;
+            }
+
+            point_indices.push_back(pos);
+        }
+
+        point_indices.erase(point_indices.begin(), point_indices.begin() + (long long) decimated_points);
+    }
+
+    if (!acquisition_buffer.select_points(point_indices)) {
+        logger::log(LEVEL_ERROR, "Wrong points subset: indices must be increasing and less than {}", points);
+
+        acquisition_buffer.reset(acquisition_ports.size());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Освобождение памяти буферов, которые используются при измерении
+ *
+ * Вызывается после завершения списка заданий, чтобы память, выделенная под
+ * результаты длинного измерения, не удерживалась до следующего запроса.
+ */
+void TaskManager::release_acquisition_buffers() {
+    acquisition_buffer = data_t{};
+    acquisition_ports = std::vector<int>{};
+    point_indices = std::vector<size_t>{};
+}
+
 /**
  * \brief Метод, обрабатывающий задание на проведение измерения и сбор данных
  *
- * \param [in] port_list JSON объект, который содержит список портов ВАЦ, для которых
- * требуется провести измерение
+ * Полученные данные добавляются в конец переданной строки, что позволяет
+ * накапливать результаты вложенных заданий без промежуточных копий.
+ *
+ * \param [in] get_data_args JSON объект, который содержит список портов ВАЦ, для которых
+ * требуется провести измерение, и, при необходимости, параметры обработки данных
+ * (см. acquire_data()), количество знаков после запятой для значений квадратур и
+ * тип выходных данных
+ * \param [in, out] data Строка, в конец которой добавляются полученные данные
  *
- * \return Если действие выполнено успешно, возвращает полученные данные. В противном
- * случае, возвращает пустую строку.
+ * \return Если действие выполнено успешно, возвращает true. В противном случае - false.
  */
-std::string TaskManager::get_data_task(json port_list) {
+bool TaskManager::get_data_task(const json &get_data_args, std::string &data) {
     logger::log(LEVEL_TRACE, "Received \"{}\" task", TASK_TYPE_GET_DATA);
 
-    std::vector<int> ports = port_list["ports"].get<std::vector<int>>();
+    int precision = DEFAULT_DATA_PRECISION;
+    if (get_data_args.contains("precision")) {
+        precision = get_data_args["precision"].get<int>();
+    }
+
+    int output = OUTPUT_IQ;
+    if (get_data_args.contains("output")) {
+        output = get_data_args["output"].get<int>();
+    }
+
+    if (!acquire_data(get_data_args)) {
+        return false;
+    }
+
+    if (!acquisition_buffer.convert(output)) {
+        logger::log(LEVEL_ERROR, "Can't convert data to output type {}", output);
+        return false;
+    }
+
+    return acquisition_buffer.append_to(data, precision);
+}
+
+/**
+ * \brief Метод, обрабатывающий задание на проведение измерения и сохраняющий
+ * полученные данные в хранилище результатов и (или) в файлы Touchstone
+ *
+ * \param [in] get_data_args JSON объект, который содержит список портов ВАЦ, для которых
+ * требуется провести измерение, и, при необходимости, параметры обработки данных
+ * (см. acquire_data())
+ * \param [in] record_index Номер записи в хранилище
+ *
+ * \return Если действие выполнено успешно, возвращает true. В противном случае - false.
+ */
+bool TaskManager::store_data_task(const json &get_data_args, uint64_t record_index) {
+    logger::log(LEVEL_TRACE, "Received \"{}\" task. Record = {}", TASK_TYPE_GET_DATA, record_index);
+
+    if (!acquire_data(get_data_args) || acquisition_buffer.points() == 0) {
+        return false;
+    }
+
+    if (result_store.is_open() && !result_store.write(record_index, acquisition_buffer)) {
+        return false;
+    }
+
+    if (touchstone_writer.is_open()) {
+        std::string group{};
+
+        if (touchstone_split == TOUCHSTONE_SPLIT_ANGLE) {
+            std::vector<std::string> angle_names{};
+
+            for (float angle : acquisition_buffer.angle_list) {
+                angle_names.push_back(std::format("{:.3f}", angle));
+            }
+
+            group = string_utils::join(angle_names, '_');
+        } else if (touchstone_split == TOUCHSTONE_SPLIT_PATH) {
+            group = current_path;
+        }
+
+        return touchstone_writer.write(group, acquisition_ports, acquisition_buffer);
+    }
+
+    return true;
+}
+
+/**
+ * \brief Метод, обрабатывающий задание на чтение записей из хранилища результатов
+ *
+ * Записи преобразуются в строку в том же формате, что и ответ на задание "get_data".
+ * Записи, которые не были сохранены (например, из-за остановки измерения),
+ * пропускаются.
+ *
+ * \param [in] read_args JSON объект, который содержит путь к хранилищу и, при
+ * необходимости, номер первой записи, количество записей, количество знаков
+ * после запятой для значений квадратур и тип выходных данных
+ * \param [out] data Строка, в которую записываются прочитанные данные
+ *
+ * \return Если хранилище было открыто, возвращает true. В противном случае - false.
+ */
+bool TaskManager::read_store_task(const json &read_args, std::string &data) {
+    logger::log(LEVEL_TRACE, "Received \"{}\" task", TASK_TYPE_READ_STORE);
+
+    ResultStore store{};
+
+    if (!store.open(read_args["path"].get<std::string>())) {
+        return false;
+    }
+
+    uint64_t first = read_args.contains("first") ? read_args["first"].get<uint64_t>() : 0;
+    uint64_t count = store.get_record_count();
+
+    if (read_args.contains("count")) {
+        count = read_args["count"].get<uint64_t>();
+    }
+
+    int precision = DEFAULT_DATA_PRECISION;
+    if (read_args.contains("precision")) {
+        precision = read_args["precision"].get<int>();
+    }
+
+    int output = OUTPUT_IQ;
+    if (read_args.contains("output")) {
+        output = read_args["output"].get<int>();
+    }
+
+    if (output < OUTPUT_IQ || output > OUTPUT_GROUP_DELAY) {
+        logger::log(LEVEL_ERROR, "Unknown output type {}", output);
+        return false;
+    }
+
+    if (output == OUTPUT_GROUP_DELAY && store.get_points() < 2) {
+        logger::log(LEVEL_ERROR, "Group delay can't be calculated for single frequency records");
+        return false;
+    }
+
+    data_t record{};
+    uint64_t total = store.get_record_count();
+    uint64_t last = first < total ? first + std::min(count, total - first) : total;
+
+    for (uint64_t record_index = first; record_index < last; ++record_index) {
+        if (store.read(record_index, record) && record.convert(output)) {
+            record.append_to(data, precision);
+        }
+    }
 
-    data_t acquired_data = device_set.get_data(ports);
-    return acquired_data.to_string();
+    return true;
+}
+
+/**
+ * \brief Метод, открывающий набор файлов Touchstone для записи результатов списка
+ * заданий
+ *
+ * Если во вложенных заданиях изменяется угловое положение ОПУ, то каждый файл
+ * должен содержать данные одного углового положения, иначе частоты в файле будут
+ * повторяться. Поэтому в этом случае по умолчанию используется разделение по
+ * угловым положениям, а другие способы разделения считаются ошибкой.
+ *
+ * \param [in] touchstone_args JSON объект, который содержит путь к файлам без
+ * расширения и, при необходимости, способ разделения результатов по файлам
+ * \param [in] angle_loops Флаг, показывающий, есть ли во вложенных заданиях циклы
+ * по угловым положениям ОПУ
+ *
+ * \return Если набор файлов открыт, возвращает true. В противном случае - false.
+ */
+bool TaskManager::open_touchstone(const json &touchstone_args, bool angle_loops) {
+    touchstone_split = angle_loops ? TOUCHSTONE_SPLIT_ANGLE : TOUCHSTONE_SPLIT_NONE;
+
+    if (touchstone_args.contains("split_by")) {
+        touchstone_split = touchstone_args["split_by"].get<std::string>();
+    }
+
+    if (touchstone_split != TOUCHSTONE_SPLIT_NONE && touchstone_split != TOUCHSTONE_SPLIT_ANGLE &&
+        touchstone_split != TOUCHSTONE_SPLIT_PATH) {
+        logger::log(LEVEL_ERROR, "Unknown touchstone split mode \"{}\"", touchstone_split);
+        return false;
+    }
+
+    if (angle_loops && touchstone_split != TOUCHSTONE_SPLIT_ANGLE) {
+        logger::log(LEVEL_ERROR, "Touchstone files must be split by angle when angle is changed in nested tasks");
+        return false;
+    }
+
+    return touchstone_writer.open(
+            touchstone_args["path"].get<std::string>(), device_set.get_vna_port_count(),
+            device_set.get_meas_type(), device_set.get_vna_source_port());
+}
+
+/**
+ * \brief Метод, формирующий описание открытого хранилища результатов, которое
+ * возвращается клиенту вместо данных
+ *
+ * \return JSON объект с путём к хранилищу, количеством записей, точек, портов и осей
+ */
+json TaskManager::result_store_handle() const {
+    return {
+            {"path", result_store.get_path()},
+            {"records", result_store.get_record_count()},
+            {"points", result_store.get_points()},
+            {"ports", result_store.get_port_count()},
+            {"axes", result_store.get_axes_count()}
+    };
 }
 
 /**
@@ -361,11 +715,21 @@ json TaskManager::proceed_task(const json &task) {
                 {WORD_RESULT_DATA, task_result}
         };
     } else if (task[WORD_TASK_TYPE] == TASK_TYPE_GET_DATA) {
-        std::string task_result = get_data_task(task[WORD_TASK_ARGS]);
+        std::string task_result{};
+        bool acquired = get_data_task(task[WORD_TASK_ARGS], task_result);
 
         result[WORD_RESULT] = {
-                {WORD_RESULT_ID, !task_result.empty() ? RESULT_OK_ID : ERR_GETTING_DATA_ID},
-                {WORD_RESULT_MSG, !task_result.empty() ? RESULT_OK_MSG : ERR_GETTING_DATA_MSG},
+                {WORD_RESULT_ID, acquired ? RESULT_OK_ID : ERR_GETTING_DATA_ID},
+                {WORD_RESULT_MSG, acquired ? RESULT_OK_MSG : ERR_GETTING_DATA_MSG},
+                {WORD_RESULT_DATA, task_result}
+        };
+    } else if (task[WORD_TASK_TYPE] == TASK_TYPE_READ_STORE) {
+        std::string task_result{};
+        bool completed = read_store_task(task[WORD_TASK_ARGS], task_result);
+
+        result[WORD_RESULT] = {
+                {WORD_RESULT_ID, completed ? RESULT_OK_ID : ERR_RESULT_STORE_ID},
+                {WORD_RESULT_MSG, completed ? RESULT_OK_MSG : ERR_RESULT_STORE_MSG},
                 {WORD_RESULT_DATA, task_result}
         };
     } else {
@@ -395,11 +759,22 @@ json TaskManager::proceed_task(const json &task) {
  * \warning Задания, у которых не требуется обработка вложенности, выполняются
  * в первую очередь! Они не передаются в метод proceed_nested_task_list()!
  *
+ * Если указан путь к хранилищу результатов, то данные вложенных заданий
+ * "get_data" сохраняются в хранилище, а вместо данных возвращается описание
+ * хранилища (см. result_store_handle()). Если указаны параметры файлов Touchstone,
+ * то данные записываются в файлы, а в ответе возвращается список файлов.
+ *
  * \param [in] task_list Список заданий, который требуется обработать
+ * \param [in] optimize_order Флаг, разрешающий изменение порядка вложенных циклов
+ * \param [in] store_path Путь к файлу хранилища результатов. Если строка пустая,
+ * то данные возвращаются в ответе.
+ * \param [in] touchstone_args Параметры записи файлов Touchstone. Если объект пустой,
+ * то файлы не создаются.
  *
  * \return Результат обработки списка заданий
  */
-json TaskManager::proceed_task_list(const json &task_list) {
+json TaskManager::proceed_task_list(
+        const json &task_list, bool optimize_order, const std::string &store_path, const json &touchstone_args) {
     json result;
     json nested_result;
 
@@ -432,7 +807,7 @@ json TaskManager::proceed_task_list(const json &task_list) {
         } else if (task.contains(WORD_NESTED) && (task[WORD_TASK_TYPE] == TASK_TYPE_CONNECT ||
         task[WORD_TASK_TYPE] == TASK_TYPE_CONFIGURE || task[WORD_TASK_TYPE] == TASK_TYPE_SET_POWER ||
         task[WORD_TASK_TYPE] == TASK_TYPE_SET_ANGLE || task[WORD_TASK_TYPE] == TASK_TYPE_SET_FREQ ||
-        task[WORD_TASK_TYPE] == TASK_TYPE_DISCONNECT)) {
+        task[WORD_TASK_TYPE] == TASK_TYPE_DISCONNECT || task[WORD_TASK_TYPE] == TASK_TYPE_READ_STORE)) {
             logger::log(
                     LEVEL_WARN,
                     R"(Task '{}' has arg 'nested', but this task cannot be nested. This arg ignored.)",
@@ -456,7 +831,68 @@ json TaskManager::proceed_task_list(const json &task_list) {
     std::sort(nested_task_list.begin(), nested_task_list.end(), array_utils::compare_nested);
     logger::log(LEVEL_TRACE, "Nested task list size = {}", nested_task_list.size());
 
-    nested_result = proceed_nested_task_list(std::move(nested_task_list));
+    if (!store_path.empty() && !result_store.create(store_path)) {
+        result[WORD_RESULT] = {
+                {WORD_RESULT_ID, ERR_RESULT_STORE_ID},
+                {WORD_RESULT_MSG, ERR_RESULT_STORE_MSG},
+                {WORD_RESULT_DATA, false}
+        };
+
+        return result;
+    }
+
+    bool angle_loops = std::any_of(
+            nested_task_list.begin(), nested_task_list.end(),
+            [](const json &nested_task) {
+                return nested_task[WORD_TASK_TYPE] == TASK_TYPE_SET_ANGLE_RANGE;
+            });
+
+    if (!touchstone_args.is_null() && !open_touchstone(touchstone_args, angle_loops)) {
+        result_store.close();
+
+        result[WORD_RESULT] = {
+                {WORD_RESULT_ID, ERR_TOUCHSTONE_ID},
+                {WORD_RESULT_MSG, ERR_TOUCHSTONE_MSG},
+                {WORD_RESULT_DATA, false}
+        };
+
+        return result;
+    }
+
+    // Если частота не является внутренним циклом, то на время обработки списка
+    // генератор переводится в режим GEN_SWEEP_LIST_BUS (см. proceed_nested_task_list())
+    int gen_sweep_mode = device_set.get_gen_sweep_mode();
+
+    nested_result = proceed_nested_task_list(std::move(nested_task_list), optimize_order);
+    release_acquisition_buffers();
+
+    if (device_set.get_gen_sweep_mode() != gen_sweep_mode && !device_set.set_gen_sweep_mode(gen_sweep_mode) &&
+            nested_result[WORD_RESULT][WORD_RESULT_ID] == RESULT_OK_ID) {
+        nested_result[WORD_RESULT] = {
+                {WORD_RESULT_ID, ERR_SET_GEN_SWEEP_MODE_ID},
+                {WORD_RESULT_MSG, ERR_SET_GEN_SWEEP_MODE_MSG},
+                {WORD_RESULT_DATA, false}
+        };
+    }
+
+    if (result_store.is_open() || touchstone_writer.is_open()) {
+        if (nested_result[WORD_RESULT][WORD_RESULT_DATA].is_string()) {
+            json handle = json::object();
+
+            if (result_store.is_open()) {
+                handle = result_store_handle();
+            }
+
+            if (touchstone_writer.is_open()) {
+                handle[WORD_TOUCHSTONE] = touchstone_writer.get_file_list();
+            }
+
+            nested_result[WORD_RESULT][WORD_RESULT_DATA] = handle;
+        }
+
+        result_store.close();
+        touchstone_writer.close();
+    }
 
     if (nested_result[WORD_RESULT][WORD_RESULT_ID] != 0 || result.is_null()) {
         return nested_result;
@@ -467,17 +903,212 @@ json TaskManager::proceed_task_list(const json &task_list) {
     return result;
 }
 
+/**
+ * \brief Метод, изменяющий порядок вложенных циклов так, чтобы реже всего
+ * перестраивались наиболее медленные устройства
+ *
+ * Для каждого цикла оценивается время одного полного прохода: (points - 1)
+ * переходов к следующей точке и один возврат в начало диапазона. Если цикл A
+ * находится внутри цикла B, то он выполняется B.points раз, поэтому A выгоднее
+ * разместить внутри B, если A.pass_time / (A.points - 1) < B.pass_time / (B.points - 1).
+ * Циклы сортируются по этому отношению, наиболее "дорогой" цикл становится
+ * внешним.
+ *
+ * Оптимизация выполняется только в том случае, если все задания "get_data"
+ * находятся во внутреннем цикле.
+ *
+ * \param [in, out] nested_task_list Список заданий, имеющих вложенность,
+ * отсортированный по уровню вложенности
+ *
+ * \return Если порядок циклов был изменён, то возвращается вектор весов для каждой
+ * позиции в списке заданий. Номер блока данных в исходном порядке равен сумме
+ * произведений номеров текущих точек циклов на их веса и позиции задания
+ * "get_data". Если порядок не изменился, то возвращается пустой вектор.
+ */
+std::vector<long long> TaskManager::optimize_nested_order(std::vector<json> &nested_task_list) {
+    struct nested_loop_t {
+        json task;
+        int points;
+        double pass_time;
+        long long stride;
+    };
+
+    std::vector<json> data_task_list{};
+    std::vector<nested_loop_t> loop_list{};
+
+    long long stride = 1;
+
+    for (const json &nested_task : nested_task_list) {
+        if (nested_task[WORD_TASK_TYPE] == TASK_TYPE_GET_DATA) {
+            if (!loop_list.empty()) {
+                logger::log(LEVEL_WARN, "Order optimization skipped: '{}' is not in the innermost loop", TASK_TYPE_GET_DATA);
+                return {};
+            }
+
+            data_task_list.push_back(nested_task);
+            continue;
+        }
+
+        const json &args = nested_task[WORD_TASK_ARGS];
+        nested_loop_t loop{nested_task, 1, 0.0, 0};
+
+        if (nested_task[WORD_TASK_TYPE] == TASK_TYPE_SET_ANGLE_RANGE) {
+            float start_angle = args["start_angle"].get<float>();
+            float stop_angle = args["stop_angle"].get<float>();
+            int axis_num = args["axis"].get<int>();
+
+            loop.points = std::max(args["points"].get<int>(), 1);
+
+            float angle_step = loop.points > 1 ? (stop_angle - start_angle) / (loop.points - 1) : 0;
+
+            loop.pass_time =
+                    (loop.points - 1) * device_set.get_angle_move_time(angle_step, axis_num) +
+                    device_set.get_angle_move_time(stop_angle - start_angle, axis_num);
+        } else if (nested_task[WORD_TASK_TYPE] == TASK_TYPE_SET_FREQ_RANGE) {
+            if (device_set.is_using_ext_gen()) {
+                loop.points = std::max(args["points"].get<int>(), 1);
+                loop.pass_time = loop.points * device_set.get_freq_step_time();
+            }
+        } else {
+            logger::log(LEVEL_WARN, "Order optimization skipped: unsupported nested task '{}'", nested_task[WORD_TASK_TYPE].get<std::string>());
+            return {};
+        }
+
+        loop.stride = stride;
+        stride *= loop.points;
+
+        loop_list.push_back(std::move(loop));
+    }
+
+    auto step_time = [](const nested_loop_t &loop) {
+        return loop.points > 1 ? loop.pass_time / (loop.points - 1) : std::numeric_limits<double>::infinity();
+    };
+
+    auto total_time = [](const std::vector<nested_loop_t> &loops) {
+        double time = 0;
+        double repeats = 1;
+
+        for (auto loop = loops.rbegin(); loop != loops.rend(); ++loop) {
+            time += repeats * loop->pass_time;
+            repeats *= loop->points;
+        }
+
+        return time;
+    };
+
+    std::vector<nested_loop_t> sorted_loop_list = loop_list;
+    std::stable_sort(
+            sorted_loop_list.begin(), sorted_loop_list.end(),
+            [&step_time](const nested_loop_t &l1, const nested_loop_t &l2) {
+                return step_time(l1) < step_time(l2);
+            });
+
+    bool order_changed = false;
+    for (size_t pos = 0; pos < loop_list.size(); ++pos) {
+        order_changed |= sorted_loop_list[pos].stride != loop_list[pos].stride;
+    }
+
+    if (!order_changed) {
+        logger::log(LEVEL_DEBUG, "Nested loop order is already optimal");
+        return {};
+    }
+
+    logger::log(
+            LEVEL_INFO,
+            "Nested loop order changed. Estimated positioning time: {:.1f} s -> {:.1f} s",
+            total_time(loop_list), total_time(sorted_loop_list));
+
+    std::vector<long long> strides{};
+    nested_task_list.clear();
+
+    for (json &data_task : data_task_list) {
+        strides.push_back((long long) strides.size());
+        nested_task_list.push_back(std::move(data_task));
+    }
+
+    for (nested_loop_t &loop : sorted_loop_list) {
+        logger::log(LEVEL_DEBUG, "Nested loop {}: {}", nested_task_list.size(), to_string(loop.task));
+
+        strides.push_back(loop.stride * (long long) data_task_list.size());
+        nested_task_list.push_back(std::move(loop.task));
+    }
+
+    return strides;
+}
+
 /**
  * \brief Метод, позволяющий произвести обработку списка заданий, с учётом вложенности
  *
+ * Если изменение порядка вложенных циклов разрешено, то данные, полученные в
+ * изменённом порядке, размещаются в соответствии с исходным порядком циклов.
+ * Если открыто хранилище результатов, то данные сохраняются в него, а номер
+ * записи совпадает с номером блока данных.
+ *
  * \param [in] nested_task_list Список заданий, имеющих вложенность
+ * \param [in] optimize_order Флаг, разрешающий изменение порядка вложенных циклов
  *
  * \return Результат обработки данных
  */
-json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
+json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list, bool optimize_order) {
     json result;
     std::string data{};
-    std::string acquired_data{};
+
+    std::vector<long long> data_strides{};
+    if (optimize_order) {
+        data_strides = optimize_nested_order(nested_task_list);
+    }
+
+    std::vector<long long> loop_counters(nested_task_list.size(), 0);
+    std::vector<std::string> data_blocks{};
+
+    uint64_t record_count = 0;
+
+    // Генератор переходит к следующей частоте после каждого измерения ВАЦ, поэтому
+    // частота должна быть внутренним циклом, а измерения в одной точке не должны
+    // повторяться (ни несколькими заданиями получения данных, ни усреднением)
+    if (device_set.get_gen_sweep_mode() == GEN_SWEEP_LIST_VNA) {
+        auto innermost_loop = std::find_if(
+                nested_task_list.begin(), nested_task_list.end(),
+                [](const json &nested_task) {
+                    return nested_task[WORD_TASK_TYPE] != TASK_TYPE_GET_DATA;
+                });
+
+        auto get_data_count = std::count_if(
+                nested_task_list.begin(), nested_task_list.end(),
+                [](const json &nested_task) {
+                    return nested_task[WORD_TASK_TYPE] == TASK_TYPE_GET_DATA;
+                });
+
+        bool averaged = std::any_of(
+                nested_task_list.begin(), nested_task_list.end(),
+                [](const json &nested_task) {
+                    return nested_task[WORD_TASK_TYPE] == TASK_TYPE_GET_DATA &&
+                           nested_task[WORD_TASK_ARGS].value("average", 1) > 1;
+                });
+
+        bool bus_trigger = false;
+
+        if (innermost_loop != nested_task_list.end() && (*innermost_loop)[WORD_TASK_TYPE] != TASK_TYPE_SET_FREQ_RANGE) {
+            logger::log(LEVEL_WARN, "Frequency is not the innermost loop. Using bus trigger for external gen");
+            bus_trigger = true;
+        } else if (get_data_count > 1) {
+            logger::log(LEVEL_WARN, "Data is measured several times per frequency. Using bus trigger for external gen");
+            bus_trigger = true;
+        } else if (averaged) {
+            logger::log(LEVEL_WARN, "Data is averaged over several measurements. Using bus trigger for external gen");
+            bus_trigger = true;
+        }
+
+        if (bus_trigger && !device_set.set_gen_sweep_mode(GEN_SWEEP_LIST_BUS)) {
+            result[WORD_RESULT] = {
+                    {WORD_RESULT_ID, ERR_SET_GEN_SWEEP_MODE_ID},
+                    {WORD_RESULT_MSG, ERR_SET_GEN_SWEEP_MODE_MSG},
+                    {WORD_RESULT_DATA, false}
+            };
+
+            return result;
+        }
+    }
 
     for (json &nested_task : nested_task_list) {
         logger::log(LEVEL_TRACE, "Preparing nested task = {}", to_string(nested_task));
@@ -538,7 +1169,30 @@ json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
         }
 
         if (nested_task_list[nested_pos][WORD_TASK_TYPE] == TASK_TYPE_GET_DATA) {
-            acquired_data = std::move(get_data_task(nested_task_list[nested_pos][WORD_TASK_ARGS]));
+            std::string *target = &data;
+            uint64_t record_index = record_count++;
+
+            if (!data_strides.empty()) {
+                long long block_pos = data_strides[nested_pos];
+
+                for (size_t pos = 0; pos < nested_task_list.size(); ++pos) {
+                    block_pos += loop_counters[pos] * data_strides[pos];
+                }
+
+                record_index = block_pos;
+
+                if (!result_store.is_open() && !touchstone_writer.is_open()) {
+                    if ((size_t) block_pos >= data_blocks.size()) {
+                        data_blocks.resize(block_pos + 1);
+                    }
+
+                    target = &data_blocks[block_pos];
+                }
+            }
+
+            bool acquired = result_store.is_open() || touchstone_writer.is_open() ?
+                    store_data_task(nested_task_list[nested_pos][WORD_TASK_ARGS], record_index) :
+                    get_data_task(nested_task_list[nested_pos][WORD_TASK_ARGS], *target);
 
             if (stop_requested) {
                 logger::log(LEVEL_WARN, "Nested task list proceeding stopped");
@@ -554,13 +1208,16 @@ json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
                 return result;
             }
 
-            if (!acquired_data.empty()) {
-                data += (data.empty() ? "" : ";") + acquired_data;
-            } else {
+            if (!acquired) {
+                // Блоки, которые ещё не были получены, пусты и не попадают в результат
+                if (!data_strides.empty()) {
+                    data = string_utils::join(data_blocks, ';');
+                }
+
                 result[WORD_RESULT] = {
                         {WORD_RESULT_ID, ERR_GETTING_DATA_ID},
                         {WORD_RESULT_MSG, ERR_GETTING_DATA_MSG},
-                        {WORD_RESULT_DATA, data}
+                        {WORD_RESULT_DATA, std::move(data)}
                 };
 
                 return result;
@@ -571,9 +1228,12 @@ json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
             } else {
                 switch (next_freq_task()) {
                     case FREQ_MOVE_OK:
+                        ++loop_counters[nested_pos];
                         nested_pos = -1;
                         continue;
                     case FREQ_MOVE_BOUND:
+                        loop_counters[nested_pos] = 0;
+
                         if (device_set.move_to_start_freq()) {
                             continue;
                         } else {
@@ -596,9 +1256,12 @@ json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
         } else if (nested_task_list[nested_pos][WORD_TASK_TYPE] == TASK_TYPE_NEXT_ANGLE) {
             switch (next_angle_task(nested_task_list[nested_pos][WORD_AXIS].get<int>())) {
                 case ANGLE_MOVE_OK:
+                    ++loop_counters[nested_pos];
                     nested_pos = -1;
                     continue;
                 case ANGLE_MOVE_BOUND:
+                    loop_counters[nested_pos] = 0;
+
                     if (device_set.move_to_start_angle(nested_task_list[nested_pos][WORD_AXIS].get<int>())) {
                         continue;
                     } else {
@@ -620,10 +1283,14 @@ json TaskManager::proceed_nested_task_list(std::vector<json> nested_task_list) {
         }
     }
 
+    if (!data_strides.empty()) {
+        data = string_utils::join(data_blocks, ';');
+    }
+
     result[WORD_RESULT] = {
             {WORD_RESULT_ID, RESULT_OK_ID},
             {WORD_RESULT_MSG, RESULT_OK_MSG},
-            {WORD_RESULT_DATA, data}
+            {WORD_RESULT_DATA, std::move(data)}
     };
 
     return result;
@@ -650,7 +1317,11 @@ std::string TaskManager::proceed(const json &data) {
         answer = proceed_task(data[WORD_TASK]);
     } else if (data.contains(WORD_TASK_LIST)) {
         logger::log(LEVEL_INFO, "Received task list");
-        answer = proceed_task_list(data[WORD_TASK_LIST]);
+        answer = proceed_task_list(
+                data[WORD_TASK_LIST],
+                data.contains(WORD_OPTIMIZE_ORDER) && data[WORD_OPTIMIZE_ORDER].get<bool>(),
+                data.contains(WORD_RESULT_STORE) ? data[WORD_RESULT_STORE].get<std::string>() : "",
+                data.contains(WORD_TOUCHSTONE) ? data[WORD_TOUCHSTONE] : json());
     } else {
         answer = {
                 WORD_RESULT, {
@@ -12,11 +12,28 @@
 
 #include "json.hpp"
 #include "devices/device_set.hpp"
+#include "storage/result_store.hpp"
+#include "storage/touchstone_writer.hpp"
+
+#include <atomic>
 
 /// Ключ, значением которого является объект задания
 #define WORD_TASK                   "task"
 /// Ключ, значением которого является объект список заданий
 #define WORD_TASK_LIST              "task_list"
+/// Ключ, значение которого разрешает изменение порядка вложенных циклов
+#define WORD_OPTIMIZE_ORDER         "optimize_order"
+/// Ключ, значением которого является путь к файлу хранилища результатов
+#define WORD_RESULT_STORE           "result_store"
+/// Ключ, значением которого является объект параметров записи файлов Touchstone
+#define WORD_TOUCHSTONE             "touchstone"
+
+/// Разделение файлов Touchstone: один файл на весь список заданий
+#define TOUCHSTONE_SPLIT_NONE       "none"
+/// Разделение файлов Touchstone: отдельный файл для каждого углового положения ОПУ
+#define TOUCHSTONE_SPLIT_ANGLE      "angle"
+/// Разделение файлов Touchstone: отдельный файл для каждого положения переключателей
+#define TOUCHSTONE_SPLIT_PATH       "path"
 
 /// Ключ, значением которого является тип задания
 #define WORD_TASK_TYPE              "type"
@@ -56,6 +73,8 @@
 
 /// Тип задания: проведение измерения и сбор данных
 #define TASK_TYPE_GET_DATA          "get_data"
+/// Тип задания: чтение записей из хранилища результатов
+#define TASK_TYPE_READ_STORE        "read_result_store"
 
 /// Тип задания: остановка
 #define TASK_TYPE_STOP              "stop"
@@ -121,6 +140,11 @@
 /// Сообщение: невозможно установить частотный диапазон
 #define ERR_SET_FREQ_RANGE_MSG      "Can't set frequency range"
 
+/// Идентификатор: невозможно изменить режим перестройки частоты внешнего генератора
+#define ERR_SET_GEN_SWEEP_MODE_ID   0x32
+/// Сообщение: невозможно изменить режим перестройки частоты внешнего генератора
+#define ERR_SET_GEN_SWEEP_MODE_MSG  "Can't change external generator sweep mode"
+
 /// Идентификатор: невозможно установить угол
 #define ERR_SET_ANGLE_ID            0x40
 /// Сообщение: невозможно установить угол
@@ -141,6 +165,16 @@
 /// Сообщение: невозможно провести измерение или (и) собрать данные с ВАЦ
 #define ERR_GETTING_DATA_MSG        "Can't acquire data from VNA"
 
+/// Идентификатор: невозможно создать или прочитать хранилище результатов
+#define ERR_RESULT_STORE_ID         0x70
+/// Сообщение: невозможно создать или прочитать хранилище результатов
+#define ERR_RESULT_STORE_MSG        "Can't access result store"
+
+/// Идентификатор: невозможно создать файлы Touchstone
+#define ERR_TOUCHSTONE_ID           0x71
+/// Сообщение: невозможно создать файлы Touchstone
+#define ERR_TOUCHSTONE_MSG          "Can't write touchstone files"
+
 /// Идентификатор: Измерение остановлено
 #define MEASUREMENTS_STOPS_ID       0xA0
 /// Сообщение: Измерение остановлено
@@ -166,8 +200,26 @@ class TaskManager {
     /// Набор устройств
     DeviceSet device_set;
 
+    /// Хранилище, в которое сохраняются результаты списка заданий
+    ResultStore result_store{};
+
+    /// Набор файлов Touchstone, в которые записываются результаты списка заданий
+    TouchstoneWriter touchstone_writer{};
+    /// Способ разделения результатов по файлам Touchstone
+    std::string touchstone_split = TOUCHSTONE_SPLIT_NONE;
+
+    /// Текущие положения переключателей в виде строки
+    std::string current_path{};
+
+    /// Буфер результатов измерения, который используется повторно для всех точек
+    data_t acquisition_buffer{};
+    /// Список портов ВАЦ последнего задания "get_data"
+    std::vector<int> acquisition_ports{};
+    /// Индексы точек, которые остаются после прореживания и выбора подмножества точек
+    std::vector<size_t> point_indices{};
+
     /// Флаг, показывающий требуется ли остановка измерений или нет
-    bool stop_requested = false;
+    std::atomic<bool> stop_requested = false;
 
     json connect_task(json device_list);
 
@@ -189,12 +241,23 @@ class TaskManager {
 
     bool set_path_task(json path_values);
 
-    std::string get_data_task(json port_list);
+    bool acquire_data(const json &get_data_args);
+    void release_acquisition_buffers();
+
+    bool get_data_task(const json &get_data_args, std::string &data);
+    bool store_data_task(const json &get_data_args, uint64_t record_index);
+
+    bool read_store_task(const json &read_args, std::string &data);
+    bool open_touchstone(const json &touchstone_args, bool angle_loops);
+    json result_store_handle() const;
 
     json proceed_task(const json &task);
-    json proceed_task_list(const json& task_list);
+    json proceed_task_list(
+            const json& task_list, bool optimize_order = false,
+            const std::string &store_path = "", const json &touchstone_args = json());
 
-    json proceed_nested_task_list(std::vector<json> nested_task_list);
+    std::vector<long long> optimize_nested_order(std::vector<json> &nested_task_list);
+    json proceed_nested_task_list(std::vector<json> nested_task_list, bool optimize_order = false);
 
 public:
     TaskManager() = default;
@@ -0,0 +1,182 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определено пространство имён complex_utils
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_COMPLEX_UTILS_HPP
+#define ANTESTL_BACKEND_COMPLEX_UTILS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+/// Флаг, показывающий, что для вычислений используются инструкции AVX2
+#define COMPLEX_UTILS_AVX2
+#endif
+
+/// Минимальная мощность, которая используется при переводе в дБ (соответствует -300 дБ)
+#define COMPLEX_UTILS_MIN_POWER     1e-30
+
+/**
+ * \brief Пространство имён, в котором определены функции для вычисления величин,
+ * производных от квадратур: модуля в дБ, фазы и группового времени запаздывания
+ *
+ * Если доступны инструкции AVX2, то арифметические операции выполняются блоками
+ * по 4 значения. Функции log10() и atan2() вычисляются поэлементно.
+ */
+namespace complex_utils {
+
+    /**
+     * \brief Вычисление модуля комплексных чисел в дБ: 10 * log10(i^2 + q^2)
+     *
+     * \param [in] i Массив синфазных составляющих
+     * \param [in] q Массив квадратурных составляющих
+     * \param [out] result Массив, в который записываются результаты
+     * \param [in] size Количество значений
+     *
+     * **Пример**
+     * \code
+     * double i[] = {1.0, 0.1}, q[] = {0.0, 0.0}, db[2];
+     * complex_utils::magnitude_db(i, q, db, 2);    // db = {0.0, -20.0}
+     * \endcode
+     */
+    inline void magnitude_db(const double *i, const double *q, double *result, size_t size) {
+        size_t pos = 0;
+
+#ifdef COMPLEX_UTILS_AVX2
+        const __m256d min_power = _mm256_set1_pd(COMPLEX_UTILS_MIN_POWER);
+
+        for (; pos + 4 <= size; pos += 4) {
+            __m256d i_block = _mm256_loadu_pd(i + pos);
+            __m256d q_block = _mm256_loadu_pd(q + pos);
+
+            __m256d power = _mm256_add_pd(_mm256_mul_pd(i_block, i_block), _mm256_mul_pd(q_block, q_block));
+            _mm256_storeu_pd(result + pos, _mm256_max_pd(power, min_power));
+        }
+
+        for (size_t block_pos = 0; block_pos < pos; ++block_pos) {
+            result[block_pos] = 10.0 * std::log10(result[block_pos]);
+        }
+#endif
+
+        for (; pos < size; ++pos) {
+            double power = std::max(i[pos] * i[pos] + q[pos] * q[pos], COMPLEX_UTILS_MIN_POWER);
+            result[pos] = 10.0 * std::log10(power);
+        }
+    }
+
+    /**
+     * \brief Вычисление фазы комплексных чисел в радианах, в диапазоне от -pi до pi
+     *
+     * \param [in] i Массив синфазных составляющих
+     * \param [in] q Массив квадратурных составляющих
+     * \param [out] result Массив, в который записываются результаты
+     * \param [in] size Количество значений
+     */
+    inline void phase(const double *i, const double *q, double *result, size_t size) {
+        for (size_t pos = 0; pos < size; ++pos) {
+            result[pos] = std::atan2(q[pos], i[pos]);
+        }
+    }
+
+    /**
+     * \brief Устранение скачков фазы на 2 * pi
+     *
+     * Если разность фаз соседних точек превышает pi, то ко всем последующим точкам
+     * добавляется величина, кратная 2 * pi.
+     *
+     * \param [in, out] phase Массив значений фазы в радианах
+     * \param [in] size Количество значений
+     */
+    inline void unwrap(double *phase, size_t size) {
+        double offset = 0.0;
+        double previous = size > 0 ? phase[0] : 0.0;
+
+        for (size_t pos = 1; pos < size; ++pos) {
+            double delta = phase[pos] - previous;
+            previous = phase[pos];
+
+            if (delta > std::numbers::pi) {
+                offset -= 2 * std::numbers::pi * std::ceil((delta - std::numbers::pi) / (2 * std::numbers::pi));
+            } else if (delta < -std::numbers::pi) {
+                offset += 2 * std::numbers::pi * std::ceil((-delta - std::numbers::pi) / (2 * std::numbers::pi));
+            }
+
+            phase[pos] += offset;
+        }
+    }
+
+    /**
+     * \brief Умножение массива на число
+     *
+     * \param [in, out] values Массив значений
+     * \param [in] size Количество значений
+     * \param [in] factor Множитель
+     */
+    inline void scale(double *values, size_t size, double factor) {
+        size_t pos = 0;
+
+#ifdef COMPLEX_UTILS_AVX2
+        const __m256d factor_block = _mm256_set1_pd(factor);
+
+        for (; pos + 4 <= size; pos += 4) {
+            _mm256_storeu_pd(values + pos, _mm256_mul_pd(_mm256_loadu_pd(values + pos), factor_block));
+        }
+#endif
+
+        for (; pos < size; ++pos) {
+            values[pos] *= factor;
+        }
+    }
+
+    /**
+     * \brief Вычисление группового времени запаздывания: -dphi / (2 * pi * df)
+     *
+     * Для внутренних точек используется центральная разность, для крайних точек -
+     * односторонняя. Если количество точек меньше 2, то результат равен 0.
+     *
+     * \param [in] phase Массив значений фазы без скачков (см. unwrap()) в радианах
+     * \param [in] freq Массив частот в Гц
+     * \param [out] result Массив, в который записываются результаты в секундах
+     * \param [in] size Количество значений
+     */
+    inline void group_delay(const double *phase, const double *freq, double *result, size_t size) {
+        if (size < 2) {
+            for (size_t pos = 0; pos < size; ++pos) {
+                result[pos] = 0.0;
+            }
+
+            return;
+        }
+
+        const double factor = -1.0 / (2 * std::numbers::pi);
+
+        result[0] = factor * (phase[1] - phase[0]) / (freq[1] - freq[0]);
+        result[size - 1] = factor * (phase[size - 1] - phase[size - 2]) / (freq[size - 1] - freq[size - 2]);
+
+        size_t pos = 1;
+
+#ifdef COMPLEX_UTILS_AVX2
+        const __m256d factor_block = _mm256_set1_pd(factor);
+
+        for (; pos + 4 < size; pos += 4) {
+            __m256d phase_delta = _mm256_sub_pd(_mm256_loadu_pd(phase + pos + 1), _mm256_loadu_pd(phase + pos - 1));
+            __m256d freq_delta = _mm256_sub_pd(_mm256_loadu_pd(freq + pos + 1), _mm256_loadu_pd(freq + pos - 1));
+
+            _mm256_storeu_pd(result + pos, _mm256_mul_pd(factor_block, _mm256_div_pd(phase_delta, freq_delta)));
+        }
+#endif
+
+        for (; pos < size - 1; ++pos) {
+            result[pos] = factor * (phase[pos + 1] - phase[pos - 1]) / (freq[pos + 1] - freq[pos - 1]);
+        }
+    }
+}
+
+#endif //ANTESTL_BACKEND_COMPLEX_UTILS_HPP
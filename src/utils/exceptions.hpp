@@ -30,6 +30,16 @@
 /// Код исключения в случае, когда ошибка возникла на устройстве
 #define DEVICE_ERROR_CODE       0xE300
 
+/// Сообщение исключения в случае, когда прибор не ответил и после повторной попытки
+#define TIMEOUT_MSG             "Device operation timed out"
+/// Код исключения в случае, когда прибор не ответил и после повторной попытки
+#define TIMEOUT_CODE            0xE400
+
+/// Сообщение исключения в случае, когда ожидание измерения прервано запросом на остановку
+#define ABORTED_MSG             "Measurement aborted"
+/// Код исключения в случае, когда ожидание измерения прервано запросом на остановку
+#define ABORTED_CODE            0xE500
+
 /// Сообщение исключения в случае, когда не получилось подключиться к устройству
 #define NO_CONNECTION_MSG       "No connection with device"
 /// Код исключения в случае, когда не получилось подключиться к устройству
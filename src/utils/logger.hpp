@@ -15,6 +15,7 @@
 #include <sys/time.h>
 #include <cmath>
 #include <format>
+#include <mutex>
 
 /// Уровень логирования, при котором отображаются только ошибки
 #define LEVEL_ERROR 0
@@ -75,6 +76,8 @@ class Logger {
     inline static int log_level = LEVEL_TRACE;
     /// Режим отображения сообщений. По-умолчанию задан режим отображения цветных тегов.
     inline static bool colored  = COLORED;
+    /// Мьютекс, который не позволяет перемешиваться сообщениям из потоков приборов
+    inline static std::mutex console_mutex{};
 
     /**
      * \brief Возвращает тег в зависимости от уровня логирования и от назначения тега.
@@ -107,6 +110,7 @@ class Logger {
      * \param [in] message Сообщение, которое требуется вывести
      */
     static void print_to_console(const std::string &message) {
+        std::lock_guard<std::mutex> lock(console_mutex);
         std::cout << message << std::endl;
     }
 
@@ -0,0 +1,140 @@
+/**
+ * \file
+ * \brief Заголовочный файл, в котором определено пространство имён number_utils
+ *
+ * \author Александр Горбунов
+ * \date 18 октября 2026
+ */
+
+#ifndef ANTESTL_BACKEND_NUMBER_UTILS_HPP
+#define ANTESTL_BACKEND_NUMBER_UTILS_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+/// Флаг, показывающий, что для поиска символов используются инструкции SSE2
+#define NUMBER_UTILS_SSE2
+#endif
+
+/**
+ * \brief Пространство имён, в котором определены функции для преобразования
+ * текстовых ответов приборов в числа
+ */
+namespace number_utils {
+
+    /**
+     * \brief Подсчёт количества символов в буфере
+     *
+     * Если доступны инструкции SSE2, то буфер просматривается блоками по 16 байт.
+     *
+     * \param [in] begin Указатель на начало буфера
+     * \param [in] end Указатель на конец буфера
+     * \param [in] symbol Требуемый символ
+     *
+     * \return Количество символов
+     *
+     * **Пример**
+     * \code
+     * std::string a = "+1.0E-001,-2.0E-001,+3.0E-001,-4.0E-001";
+     * size_t b = number_utils::count(a.data(), a.data() + a.size(), ',');    // b = 3
+     * \endcode
+     */
+    inline size_t count(const char *begin, const char *end, char symbol) {
+        size_t count = 0;
+
+#ifdef NUMBER_UTILS_SSE2
+        const __m128i pattern = _mm_set1_epi8(symbol);
+
+        for (; end - begin >= 16; begin += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+
+            while (mask != 0) {
+                mask &= mask - 1;
+                ++count;
+            }
+        }
+#endif
+
+        for (; begin < end; ++begin) {
+            if (*begin == symbol) {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * \brief Преобразует список чисел, разделённых заданным символом, в массивы
+     * чётных и нечётных значений
+     *
+     * Числа читаются прямо из буфера с помощью std::from_chars(), без создания
+     * промежуточных строк. Знак '+' и пробелы перед числом пропускаются, так как
+     * std::from_chars() их не принимает.
+     *
+     * \param [in] begin Указатель на начало буфера
+     * \param [in] end Указатель на конец буфера
+     * \param [in] delimiter Разделитель чисел
+     * \param [out] even Массив, в который записываются значения с чётными индексами
+     * \param [out] odd Массив, в который записываются значения с нечётными индексами
+     * \param [in] max_pairs Максимальное количество пар, которое требуется прочитать.
+     * Если значение меньше или равно 0, то читаются все пары.
+     *
+     * \return Количество прочитанных пар
+     *
+     * **Пример**
+     * \code
+     * std::string a = "+1.0E-001,-2.0E-001,+3.0E-001,-4.0E-001";
+     * std::vector<double> i{}, q{};
+     *
+     * number_utils::parse_pairs(a.data(), a.data() + a.size(), ',', i, q);  // i = {0.1, 0.3}, q = {-0.2, -0.4}
+     * \endcode
+     */
+    inline size_t parse_pairs(
+            const char *begin, const char *end, char delimiter,
+            std::vector<double> &even, std::vector<double> &odd, int max_pairs = 0) {
+        size_t pairs = (count(begin, end, delimiter) + 1) / 2;
+
+        if (max_pairs > 0 && pairs > (size_t) max_pairs) {
+            pairs = max_pairs;
+        }
+
+        even.resize(pairs);
+        odd.resize(pairs);
+
+        size_t parsed = 0;
+        double value[2];
+
+        while (parsed < pairs) {
+            for (double &item : value) {
+                while (begin < end && (*begin == '+' || *begin == ' ')) {
+                    ++begin;
+                }
+
+                auto [ptr, error] = std::from_chars(begin, end, item);
+
+                if (error != std::errc()) {
+                    even.resize(parsed);
+                    odd.resize(parsed);
+
+                    return parsed;
+                }
+
+                begin = ptr < end ? ptr + 1 : ptr;
+            }
+
+            even[parsed] = value[0];
+            odd[parsed] = value[1];
+
+            ++parsed;
+        }
+
+        return parsed;
+    }
+}
+
+#endif //ANTESTL_BACKEND_NUMBER_UTILS_HPP
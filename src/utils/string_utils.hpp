@@ -117,6 +117,38 @@ namespace string_utils {
     inline std::string rstrip(const std::string &source, char strip_symbol) {
         return source.substr(0, source.rfind(strip_symbol));
     }
+
+    /**
+     * \brief Объединение вектора строк в одну строку через заданный делитель
+     *
+     * \param [in] source Вектор строк, которые требуется объединить
+     * \param [in] delimiter Делитель
+     *
+     * \return Строка, в которую вошли все непустые элементы вектора
+     *
+     * **Пример**
+     * \code
+     * std::vector<std::string> a = {"address1", "", "address3"};
+     * std::string b = string_utils::join(a, ';');      // Будет получена строка "address1;address3"
+     * \endcode
+     */
+    inline std::string join(const std::vector<std::string> &source, char delimiter = DEFAULT_DELIMITER) {
+        std::string out{};
+
+        for (const std::string &item : source) {
+            if (item.empty()) {
+                continue;
+            }
+
+            if (!out.empty()) {
+                out.push_back(delimiter);
+            }
+
+            out += item;
+        }
+
+        return out;
+    }
 }
 
 #endif //ANTESTL_BACKEND_STRING_UTILS_HPP